@@ -55,6 +55,8 @@ void I2C_0_set_baud_rate(uint32_t baud);
 
 void I2C_0_set_buffer(void *buffer, size_t bufferSize);
 
+uint8_t I2C_0_get_state(void);
+
 // Event Callback functions.
 
 void I2C_0_set_data_complete_callback(i2c_callback cb, void *p);
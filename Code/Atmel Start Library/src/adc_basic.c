@@ -61,7 +61,7 @@ int8_t ADC_0_init()
 	ADCSRA = (1 << ADEN)        /* ADC: enabled */
 	         | (0 << ADATE)     /* Auto Trigger: disabled */
 	         | (1 << ADIE)      /* ADC Interrupt: enabled */
-	         | (0x01 << ADPS0); /* 2 */
+	         | (0x07 << ADPS0); /* 128: 125kHz at 16MHz, inside the 50-200kHz needed for 10 bits */
 	ADCSRB = (0x00 << ADTS0)    /* Free Running mode */
 	         | (0 << ACME)      /* Analog Comparator Multiplexer: disabled */
 	    ;
@@ -41,6 +41,7 @@
 #include <util/delay.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include "profiler.h"
 // #include "timeout.h"  // TODO: Add timeout integration
 
 /***************************************************************************/
@@ -267,6 +268,14 @@ void I2C_0_set_address(i2c_address_t address)
 	I2C_0_status.address = address;
 }
 
+/**
+ * \brief Get the current state of the driver FSM (i2c_fsm_states_t value). Used for fault reports.
+ */
+uint8_t I2C_0_get_state(void)
+{
+	return I2C_0_status.state;
+}
+
 /**
  * \brief Close the I2C interface
  *
@@ -656,7 +665,9 @@ stateHandlerFunction *I2C_0_fsmStateTable[] = {
 
 ISR(TWI_vect)
 {
+	PROF_ENTER(PROF_ISR_TWI);
 	I2C_0_master_isr();
+	PROF_EXIT(PROF_ISR_TWI);
 }
 
 void I2C_0_master_isr(void)
@@ -34,6 +34,8 @@ typedef struct lcd_s
 	uint8_t displaycontrol;
 	uint8_t cursorDisplayShift;
 	uint8_t functionSet;
+	
+	uint32_t powerOnMs;		// When lcdPowerOn ran. Power-on wait is measured from here
 
 } lcd_t;
 
@@ -42,6 +44,11 @@ typedef struct lcd_s
 /************************************************************************/
 void lcdInit(lcd_t *lcdP, mcp23017_t *ioExpander, volatile uint8_t *ctrlDdr, volatile uint8_t *ctrlPort,
 			 uint8_t rwPin, uint8_t rsPin, uint8_t enPin, bool lines, bool font);
+
+void lcdPowerOn(lcd_t *lcdP, mcp23017_t *ioExpander, volatile uint8_t *ctrlDdr, volatile uint8_t *ctrlPort,
+				uint8_t rsPin, uint8_t rwPin, uint8_t enPin, bool lines, bool font);
+
+void lcdInitComplete(lcd_t *lcdP);
 			 
 void lcdClear(lcd_t *lcdP);
 
@@ -11,6 +11,13 @@
 /************************************************************************/
 #include "stdint.h"
 #include "stdbool.h"
+#include "adc_engine.h"
+
+#define SOIL_SAMPLE_COUNT			(10)		// ADC conversions averaged per reading
+#define SOIL_STABILIZE_MS			(10)		// Sensor settle time after the relay closes
+#define SOIL_FULL_SCALE				(1000)		// Moisture is reported in per mille of the calibrated range
+#define SOIL_OVERSAMPLE_LOG4		(2)			// n: 4^n conversions per sample, 10 + n bits. At most 2 so
+												// SOIL_SAMPLE_COUNT 12-bit samples still sum into a uint16_t
 
 #ifndef MOISTURE_SENSOR_H_
 #define MOISTURE_SENSOR_H_
@@ -30,21 +37,34 @@ typedef enum soil_moisture_sensor_state_e
 /************************************************************************/
 /*				            Struct Definition							*/
 /************************************************************************/
-typedef struct soil_moisture_sensor_s
+typedef struct soil_moisture_sensor_s soil_moisture_sensor_t;
+typedef void (*soil_sens_cb_t)(void *objP, const soil_moisture_sensor_t *sensorP);
+
+struct soil_moisture_sensor_s
 {
 	soil_moisture_sensor_state_e state; 
-	double moisture;
+	uint16_t moisture;			// 0 (wet bound) .. SOIL_FULL_SCALE (dry bound)
+	uint16_t rawSum;			// Sum of the last SOIL_SAMPLE_COUNT samples (10 + SOIL_OVERSAMPLE_LOG4 bits)
+	uint16_t wetSum;			// Calibration bounds, in rawSum units
+	uint16_t drySum;
+	uint32_t rangeRecipQ16;		// (SOIL_FULL_SCALE << 16) / (drySum - wetSum). 0 while uncalibrated
 	uint8_t sampleNum;
-	uint16_t timeStamp;
+	uint32_t timeStamp;			// getMillis when the relay was closed
 	bool calibrateFlag;
-} soil_moisture_sensor_t;
+	adc_job_t job;				// Burst of SOIL_SAMPLE_COUNT oversampled samples on the sensor channel
+	uint16_t samples[SOIL_SAMPLE_COUNT];
+	soil_sens_cb_t funcP;		// Runs when a reading completes
+	void *objP;
+};
 
 /************************************************************************/
 /*							Public Interfaces    	                    */
 /************************************************************************/
-void soilSensInit(soil_moisture_sensor_t *sensorP);
-double soilSenGetMoisture(soil_moisture_sensor_t *sensorP);
+void soilSensInit(soil_moisture_sensor_t *sensorP, soil_sens_cb_t funcP, void *objP);
+uint16_t soilSenGetMoisture(soil_moisture_sensor_t *sensorP);
+bool soilSensSetCalibration(soil_moisture_sensor_t *sensorP, const uint16_t wetRaw, const uint16_t dryRaw);
 void soilSenPwrRelay(bool relayState);
 void soilSenCalibrate(soil_moisture_sensor_t *sensorP);
-void readSens(soil_moisture_sensor_t *sensorP);
+bool readSens(soil_moisture_sensor_t *sensorP);
+void soilSensService(soil_moisture_sensor_t *sensorP);
 #endif /* MOISTURE_SENSOR_H_ */
\ No newline at end of file
@@ -0,0 +1,51 @@
+/*
+ * adaptive_sched.h
+ *
+ * Created: 10/20/2026 12:24:38 AM
+ *  Author: plete
+ *
+ * Adaptive sampling interval for one sensor channel. While consecutive readings stay within a dead-band the
+ * interval doubles, up to maxMs. A bigger change scales it down by deadBand / change, so a smooth signal
+ * settles where each sample moves about one dead-band. As soon as the change rate exceeds the slope limit it
+ * drops straight back to minMs so fast events are followed closely.
+ */
+
+
+#ifndef ADAPTIVE_SCHED_H_
+#define ADAPTIVE_SCHED_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef struct adapt_sched_s
+{
+	uint32_t minMs;				// Shortest interval, used while the signal moves fast
+	uint32_t maxMs;				// Longest interval, reached while the signal is flat
+	uint16_t deadBand;			// |change| between samples that counts as flat (channel units)
+	uint16_t slopePerMin;		// Change rate that counts as an event (channel units per minute)
+	uint32_t intervalMs;		// Current interval
+	uint32_t startMs;			// getMillis when the last sample was started
+	uint32_t valueMs;			// startMs of the sample lastValue came from
+	int16_t lastValue;
+	bool hasValue;
+} adapt_sched_t;
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+void adaptSchedInit(adapt_sched_t *schedP, const uint32_t minMs, const uint32_t maxMs, const uint16_t deadBand,
+					const uint16_t slopePerMin);
+
+bool adaptSchedDue(const adapt_sched_t *schedP, const uint32_t nowMs);
+
+void adaptSchedStarted(adapt_sched_t *schedP, const uint32_t nowMs);
+
+void adaptSchedUpdate(adapt_sched_t *schedP, const int16_t value);
+
+#endif /* ADAPTIVE_SCHED_H_ */
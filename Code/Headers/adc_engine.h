@@ -0,0 +1,86 @@
+/*
+ * adc_engine.h
+ *
+ * Created: 10/20/2026 1:48:15 AM
+ *  Author: plete
+ *
+ * Interrupt driven ADC bursts. A job asks for count samples of one channel into a caller owned buffer.
+ * Jobs wait in a small queue; ADC_vect stores each result, starts the next conversion and moves on to the next
+ * job when one is full, so the CPU only spends the ISR on a burst. Finished jobs are handed back through a
+ * second queue and their callback runs from adcEngineService in the main loop, never in interrupt context.
+ * A job with periodUs set is paced by Timer0 compare match A auto triggering the ADC instead of starting the
+ * next conversion back to back. Timer0 only runs while such a job is active.
+ * A quiet job converts only while the CPU sits in ADC Noise Reduction sleep: the main loop calls
+ * adcEngineQuietSleep while adcEngineQuietPending is true, and entering that sleep starts the conversion. CPU,
+ * I/O and TWI clocks are halted meanwhile, Timer1 (getMillis) included, which would lose 16.6ms per 12-bit soil
+ * burst. adcEngineQuietSleep puts the conversion time back on Timer1 after each ADC wake-up instead, leaving
+ * about 4us of error per conversion plus up to 112us per wake-up by another interrupt. The alternative, idle
+ * sleep with ADSC, keeps Timer1 exact but leaves the I/O clock and Timer1/Timer0 switching next to the ADC.
+ * With oversampleLog4 = n every stored sample is the sum of 4^n conversions shifted right by n, i.e. 10 + n bits.
+ * That only gains resolution if there is at least about 1 LSB of noise on the input.
+ */
+
+
+#ifndef ADC_ENGINE_H_
+#define ADC_ENGINE_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ADC_ENGINE_MAX_JOBS			(4)			// Jobs waiting to start. Power of two
+#define ADC_ENGINE_MAX_PERIOD_US	(1024)		// Timer0 at F_CPU / 64 counts 4us steps up to 256
+#define ADC_ENGINE_MIN_PERIOD_US	(112)		// An auto triggered conversion takes 13.5 ADC clocks
+#define ADC_ENGINE_CONV_US			(104)		// 13 ADC clocks at F_CPU / 128 = 125kHz
+#define ADC_ENGINE_MAX_OVERSAMPLE	(3)			// 4^3 conversions of 1023 still fit the 16-bit accumulator
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef void (*adc_job_cb_t)(void *objP, const uint16_t *samplesP, const uint8_t count);
+
+typedef struct adc_job_s
+{
+	uint8_t channel;				// ADMUX MUX3:0 value
+	uint8_t count;					// Samples wanted, samplesP holds at least this many
+	uint16_t periodUs;				// 0: back to back. Otherwise Timer0 paced, multiple of 4us and longer
+									// than one conversion
+	uint8_t oversampleLog4;			// n: each sample is 4^n conversions decimated to 10 + n bits
+	bool quiet;						// Convert in ADC Noise Reduction sleep only. Not with periodUs
+	uint16_t *samplesP;
+	adc_job_cb_t funcP;				// Runs from adcEngineService once all samples are in
+	void *objP;
+	volatile uint8_t taken;			// Samples stored so far. Written by ADC_vect
+	bool busy;						// Queued and callback not run yet. The job must not be touched meanwhile
+} adc_job_t;
+
+/* Worst case figures for a job with the current ADC clock */
+typedef struct adc_timing_s
+{
+	uint16_t conversions;			// ADC conversions for the whole job
+	uint8_t bits;					// Resolution of each stored sample
+	uint32_t sampleUs;				// Time per stored sample (4^n conversions)
+	uint32_t burstUs;				// Time for the whole job, not counting wake-ups between quiet conversions
+	uint16_t samplesPerSec;			// Stored samples per second while the job runs
+} adc_timing_t;
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+void adcEngineInit(void);
+
+bool adcEngineQueue(adc_job_t *jobP);
+
+void adcEngineService(void);
+
+bool adcEngineIsBusy(void);
+
+bool adcEngineQuietPending(void);
+
+void adcEngineQuietSleep(void);
+
+void adcEngineGetTiming(const adc_job_t *jobP, adc_timing_t *timingP);
+
+#endif /* ADC_ENGINE_H_ */
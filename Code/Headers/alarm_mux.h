@@ -0,0 +1,50 @@
+/*
+ * alarm_mux.h
+ *
+ * Created: 10/19/2026 7:34:09 PM
+ *  Author: plete
+ *
+ * Software alarms multiplexed onto DS3231 Alarm 1 (Alarm 2 stays with the display refresh). Alarms live in a
+ * fixed pool ordered by a binary min-heap on their due time, so adding, cancelling and firing are O(log n).
+ * Only the earliest alarm is programmed into the hardware; when it fires, every due alarm runs in due time
+ * order (ties in the order they were added), recurring ones are re-armed and the next earliest is programmed.
+ * Callbacks may add and cancel alarms; Alarm 1 is only reprogrammed once the whole due batch has run.
+ * An id carries its slot's generation, so an id kept after its one shot fired can't cancel a newer alarm that
+ * reused the slot (until the generation wraps after 256 reuses).
+ * Needs the RTC in alarm mode: in tick mode ds3231SetAlarm1 fails and nothing reaches the hardware.
+ */
+
+
+#ifndef ALARM_MUX_H_
+#define ALARM_MUX_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "ds3231.h"
+#include "epoch.h"
+
+#define ALARM_MUX_MAX_ALARMS	(4)			// 16 bytes each
+#define ALARM_MUX_INVALID_ID	(0xFFFF)
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef uint16_t alarm_id_t;		// Generation << 8 | pool slot
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+void alarmMuxInit(ds3231_t *rtcP);
+
+alarm_id_t alarmMuxAdd(const epoch_t when, const uint32_t periodS, void (*funcP)(void *objP), void *objP);
+
+bool alarmMuxCancel(const alarm_id_t id);
+
+bool alarmMuxNext(epoch_t *whenP);
+
+void alarmMuxReschedule(void);
+
+#endif /* ALARM_MUX_H_ */
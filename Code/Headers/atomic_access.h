@@ -0,0 +1,85 @@
+/*
+ * atomic_access.h
+ *
+ * Created: 10/19/2026 9:40:51 AM
+ *  Author: plete
+ *
+ * Snapshot helpers for variables shared with ISRs. The AVR moves one byte at a time, so any access to a
+ * multi-byte variable the ISR may change mid-way (e.g. the 32-bit millisecond count) must be done with
+ * interrupts masked. Built on the ENTER/EXIT_CRITICAL macros so the caller's interrupt state is restored.
+ */
+
+
+#ifndef ATOMIC_ACCESS_H_
+#define ATOMIC_ACCESS_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <atomic.h>
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+
+/* Read a 16-bit variable shared with an ISR */
+static inline uint16_t atomicRead16(const volatile uint16_t *srcP)
+{
+	uint16_t val;
+	ENTER_CRITICAL(R);
+	val = *srcP;
+	EXIT_CRITICAL(R);
+	return val;
+}
+
+/* Read a 32-bit variable shared with an ISR */
+static inline uint32_t atomicRead32(const volatile uint32_t *srcP)
+{
+	uint32_t val;
+	ENTER_CRITICAL(R);
+	val = *srcP;
+	EXIT_CRITICAL(R);
+	return val;
+}
+
+/* Write a 16-bit variable shared with an ISR */
+static inline void atomicWrite16(volatile uint16_t *dstP, const uint16_t val)
+{
+	ENTER_CRITICAL(W);
+	*dstP = val;
+	EXIT_CRITICAL(W);
+}
+
+/* Write a 32-bit variable shared with an ISR */
+static inline void atomicWrite32(volatile uint32_t *dstP, const uint32_t val)
+{
+	ENTER_CRITICAL(W);
+	*dstP = val;
+	EXIT_CRITICAL(W);
+}
+
+/* Return a flag set by an ISR and clear it in the same step so no set can be lost in between */
+static inline bool atomicTestAndClear(volatile bool *flagP)
+{
+	bool val;
+	ENTER_CRITICAL(T);
+	val = *flagP;
+	*flagP = false;
+	EXIT_CRITICAL(T);
+	return val;
+}
+
+/* Return a counter incremented by an ISR and reset it in the same step */
+static inline uint8_t atomicFetchAndClear8(volatile uint8_t *countP)
+{
+	uint8_t val;
+	ENTER_CRITICAL(T);
+	val = *countP;
+	*countP = 0;
+	EXIT_CRITICAL(T);
+	return val;
+}
+
+#endif /* ATOMIC_ACCESS_H_ */
@@ -0,0 +1,115 @@
+/*
+ * bme_acq.h
+ *
+ * Created: 10/19/2026 9:12:44 PM
+ *  Author: plete
+ *
+ * Non-blocking BME280 forced-mode acquisition. bmeAcqStart queues one measurement and bmeAcqService, called
+ * every main loop pass, walks it through configure (first time only) -> trigger -> wait -> read -> compensate
+ * -> publish, one step per call. The wait is a getMillis deadline from bme280_cal_meas_delay; the status
+ * register measuring bit is polled on the way so the read happens as soon as the conversion is done.
+ * BME280_32BIT_ENABLE builds compensate with bmeCompensate (see bme_comp.h), 64-bit and float builds with the
+ * driver.
+ * bmeAcqStartStream instead leaves the sensor free running in normal mode (standby time and IIR filter from
+ * the settings) and only burst reads the data registers once per output period until bmeAcqStop. If getting it
+ * into normal mode fails, the whole setup is retried one output period later until it sticks.
+ * The last settings written and the sensor power mode are cached, so only registers that changed are sent
+ * and a trigger is a single ctrl_meas write. The cache assumes nothing else talks to the sensor.
+ * Several sensors can share one bme280_dev (bus functions): each acquisition keeps its own I2C address and
+ * calibration copy and points intf_ptr at its address before every transfer. Starting all of them in the
+ * same pass lets the conversions run in parallel and the results come back on consecutive passes.
+ */
+
+
+#ifndef BME_ACQ_H_
+#define BME_ACQ_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "BME280_driver-master/bme280.h"
+
+#define BME_ACQ_STATUS_POLL_MS		(2)		// Time between measuring bit polls while waiting
+
+/************************************************************************/
+/*							Enums Definition		 	                */
+/************************************************************************/
+typedef enum bme_acq_state_e
+{
+	BME_ACQ_IDLE = 0,
+	BME_ACQ_CONFIGURE,		// Write the settings registers that changed
+	BME_ACQ_TRIGGER,		// Start a forced conversion or normal mode
+	BME_ACQ_WAIT,			// Conversion running
+	BME_ACQ_READ,			// Burst read the data registers
+	BME_ACQ_COMPENSATE,		// Raw -> physical units
+	BME_ACQ_PUBLISH,		// Hand the result to the callback
+	BME_ACQ_STREAM			// Normal mode, waiting for the next output period (or to retry a failed start)
+} bme_acq_state_t;
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef void (*bme_acq_cb_t)(void *objP, const struct bme280_data *dataP);
+
+/* Integer display units, from whichever compensation the build uses */
+typedef struct bme_display_s
+{
+	int16_t tempF100;			// Degrees F x100
+	int16_t tempC100;			// Degrees C x100
+	uint16_t humidity100;		// %RH x100
+	uint16_t pressure10;		// hPa x10
+} bme_display_t;
+
+typedef struct bme_acq_s
+{
+	struct bme280_dev *devP;			// May be shared with other sensors on the bus
+	uint8_t addr;						// BME280_I2C_ADDR_PRIM or BME280_I2C_ADDR_SEC, intf_ptr target
+	struct bme280_calib_data calib;		// Copied from devP right after bme280_init
+	struct bme280_settings settings;	// Wanted oversampling/filter/standby
+	struct bme280_settings applied;		// What ctrl_hum/config currently hold
+	bool appliedValid;					// false: register contents unknown, write them all
+	uint8_t powerMode;					// BME280_SLEEP_MODE/FORCED_MODE/NORMAL_MODE as last written
+	bool streaming;						// Normal mode requested
+	bme_acq_state_t state;
+	uint32_t triggerMs;					// getMillis when the conversion was started
+	uint32_t lastPollMs;				// getMillis of the last measuring bit poll
+	uint8_t maxWaitMs;					// bme280_cal_meas_delay for the settings
+	uint16_t periodMs;					// Normal mode output period (measurement + standby)
+	uint32_t lastReadMs;				// getMillis of the last normal mode read
+	uint8_t lastWaitMs;					// How long the last conversion actually took
+	uint8_t rawData[BME280_P_T_H_DATA_LEN];
+	struct bme280_data data;			// Last published result
+	bool dataValid;						// data holds at least one good measurement
+	int8_t lastResult;					// BME280_OK or the last driver error
+	uint16_t errorCount;				// Acquisitions dropped on a driver error (saturates)
+	bme_acq_cb_t funcP;
+	void *objP;
+} bme_acq_t;
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+void bmeAcqInit(bme_acq_t *acqP, struct bme280_dev *devP, const uint8_t addr,
+				const struct bme280_settings *settingsP, bme_acq_cb_t funcP, void *objP);
+
+bool bmeAcqStart(bme_acq_t *acqP);
+
+bool bmeAcqStartStream(bme_acq_t *acqP);
+
+bool bmeAcqStop(bme_acq_t *acqP);
+
+bool bmeAcqSetSettings(bme_acq_t *acqP, const struct bme280_settings *settingsP);
+
+void bmeAcqService(bme_acq_t *acqP);
+
+bool bmeAcqIsBusy(const bme_acq_t *acqP);
+
+bool bmeAcqGetData(const bme_acq_t *acqP, struct bme280_data *dataP);
+
+void bmeAcqToDisplay(const struct bme280_data *dataP, bme_display_t *dispP);
+
+int16_t bmeAcqC100ToF100(const int16_t tempC100);
+
+#endif /* BME_ACQ_H_ */
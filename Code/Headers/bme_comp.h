@@ -0,0 +1,34 @@
+/*
+ * bme_comp.h
+ *
+ * Created: 10/20/2026 2:14:09 PM
+ *  Author: plete
+ *
+ * BME280 compensation in 32-bit integer math, kept out of the vendor driver. It is the datasheet fixed-point
+ * formula set (the driver's BME280_32BIT_ENABLE variant) with one change: the dig_p2 * var1 term of the pressure
+ * formula overflows int32 near -40C on parts with a large |dig_p2|, so var1 is scaled down before the multiply.
+ * The driver's default 64-bit pressure path costs a dozen int64 libgcc calls per reading on AVR for no visible
+ * gain at the 0.1 hPa display resolution.
+ * Results use the integer struct bme280_data: temperature 0.01C, pressure Pa, humidity 1/1024 %RH.
+ * bme_acq uses it in place of the driver when BME280_32BIT_ENABLE is in the project symbols. Without it the
+ * driver defaults to its 64-bit path (pressure in 0.01 Pa); BME280_FLOAT_ENABLE builds use the float one.
+ */
+
+
+#ifndef BME_COMP_H_
+#define BME_COMP_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include "BME280_driver-master/bme280.h"
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+#ifndef BME280_FLOAT_ENABLE
+void bmeCompensate(const struct bme280_uncomp_data *uncompP, struct bme280_calib_data *calibP,
+				   struct bme280_data *dataP);
+#endif
+
+#endif /* BME_COMP_H_ */
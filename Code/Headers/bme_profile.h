@@ -0,0 +1,54 @@
+/*
+ * bme_profile.h
+ *
+ * Created: 10/19/2026 11:36:50 PM
+ *  Author: plete
+ *
+ * Named BME280 measurement profiles. Each one sets oversampling, IIR filter and standby time for a use case,
+ * and reports its worst case conversion time (bme280_cal_meas_delay) and an estimate of the sensor charge per
+ * sample from the datasheet typical phase durations and currents. Profiles can be switched at runtime; the
+ * acquisition only rewrites the registers that change.
+ */
+
+
+#ifndef BME_PROFILE_H_
+#define BME_PROFILE_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "bme_acq.h"
+
+/************************************************************************/
+/*							Enums Definition		 	                */
+/************************************************************************/
+typedef enum bme_profile_e
+{
+	BME_PROFILE_WEATHER = 0,		// 1x T/P/H, no filter: datasheet weather monitoring
+	BME_PROFILE_LOW_POWER,			// 1x T/H, pressure skipped, no filter
+	BME_PROFILE_HIGH_ACCURACY,		// 4x T/P/H, IIR 4
+	BME_NUM_PROFILES
+} bme_profile_t;
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef struct bme_profile_info_s
+{
+	const char *name;			// <= 8 chars for the LCD
+	uint8_t measMs;				// Worst case conversion time
+	uint16_t chargeNc;			// Estimated sensor charge per sample, nC (uA x ms)
+} bme_profile_info_t;
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+bool bmeProfileGetSettings(const bme_profile_t profile, struct bme280_settings *settingsP);
+
+bool bmeProfileGetInfo(const bme_profile_t profile, bme_profile_info_t *infoP);
+
+bool bmeProfileApply(bme_acq_t *acqP, const bme_profile_t profile);
+
+#endif /* BME_PROFILE_H_ */
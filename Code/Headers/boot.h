@@ -0,0 +1,47 @@
+/*
+ * boot.h
+ *
+ * Created: 10/19/2026 4:02:18 PM
+ *  Author: plete
+ *
+ * Boot sequencer. Work needed for the first frame runs inline in main, ordered so the slow LCD power-on wait
+ * overlaps the expander and RTC setup. Everything else (CGRAM glyphs, sensor calibration reads) is queued with
+ * bootDefer and run by bootRunDeferred once the first frame is on screen. Boot timings are kept for diagnostics.
+ */
+
+
+#ifndef BOOT_H_
+#define BOOT_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BOOT_MAX_DEFERRED		(4)
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef bool (*boot_step_cb_t)(void);
+
+typedef struct boot_times_s
+{
+	uint32_t firstFrameUs;		// Timer start to first frame on the LCD
+	uint32_t deferredUs;		// Timer start to last deferred step done (0 if still pending)
+	uint8_t failedSteps;		// Bit n set if deferred step n returned false
+} boot_times_t;
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+bool bootDefer(boot_step_cb_t stepCB);
+
+void bootFirstFrame(void);
+
+bool bootRunDeferred(void);
+
+void bootGetTimes(boot_times_t *timesP);
+
+#endif /* BOOT_H_ */
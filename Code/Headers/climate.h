@@ -0,0 +1,54 @@
+/*
+ * climate.h
+ *
+ * Created: 10/19/2026 10:41:27 PM
+ *  Author: plete
+ *
+ * Plant climate metrics from air temperature and %RH: saturation vapour pressure, vapour pressure deficit,
+ * dew point and absolute humidity. Integer only: the saturation vapour pressure comes from a 1C step Magnus
+ * table in flash with linear interpolation, and the dew point from the same table searched backwards, so no
+ * exp/log is linked. Each climateUpdate also folds the VPD into a running average.
+ */
+
+
+#ifndef CLIMATE_H_
+#define CLIMATE_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CLIMATE_MIN_C			(-20)	// Table range, inputs outside are clamped
+#define CLIMATE_MAX_C			(60)
+#define CLIMATE_AVG_SHIFT		(3)		// VPD average weighs each new sample 1/8
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef struct climate_s
+{
+	uint16_t svpPa;				// Saturation vapour pressure at the air temperature
+	uint16_t vapourPa;			// Actual vapour pressure
+	uint16_t vpdPa;				// Vapour pressure deficit
+	int16_t dewPointC100;		// Dew point, C x100
+	uint16_t absHumidity100;	// Absolute humidity, g/m3 x100
+	uint32_t vpdAvgScaled;		// Running VPD average, Pa << CLIMATE_AVG_SHIFT
+	uint16_t samples;			// Samples since climateReset (saturates)
+} climate_t;
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+void climateReset(climate_t *climateP);
+
+void climateUpdate(climate_t *climateP, const int16_t tempC100, const uint16_t rh100);
+
+uint16_t climateVpdAverage(const climate_t *climateP);
+
+uint16_t climateSvp(const int16_t tempC100);
+
+int16_t climateDewPoint(const uint16_t vapourPa);
+
+#endif /* CLIMATE_H_ */
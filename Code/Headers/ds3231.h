@@ -15,8 +15,12 @@
 #include "stdbool.h"
 #include "stdint.h"
 #include "alarm.h"
+#include "ring_buffer.h"
 
 #define DIGITS_PER_TIME_UNIT	(0x02)
+#define DS3231_DEF_VERIFY_INTERVAL	(60)	// Polls between full register checks (1 == every poll)
+#define DS3231_TICK_RESYNC_S		(3600)	// Tick mode re-reads the time registers this often
+#define DS3231_ERROR_LOG_SIZE		(4)		// Power of two. Last few error events kept with their timestamp
 
 /************************************************************************/
 /*						Enums Definition				                */
@@ -46,7 +50,10 @@ enum ds3231_errors_e
 	INCONSISTENT_STAT_REG,
 	INCONSISTENT_A1,
 	INCONSISTENT_A2,
-	OSC_STOP
+	OSC_STOP,
+	I2C_TRANSFER_FAIL,
+	INVALID_TIME,						// Time registers read back out of range
+	DS3231_NUM_ERRORS
 };
 
 typedef enum alarm_pos_e
@@ -59,6 +66,12 @@ typedef enum alarm_pos_e
 /************************************************************************/
 /*				Type Defs + Struct Implementation						*/
 /************************************************************************/
+typedef struct ds3231_error_event_s
+{
+	uint32_t timeMs;					// getMillis() when it happened
+	uint8_t error;						// enum ds3231_errors_e
+} ds3231_error_event_t;
+
 typedef struct ds3231_s 
 {
 	uint8_t time[TIME_UNITS_TOTAL];
@@ -67,9 +80,34 @@ typedef struct ds3231_s
 	uint8_t ctrlReg;
 	uint8_t ctrlStatReg;
 	uint8_t agingOffsetReg;
-	uint16_t tempReg;
-	uint8_t errorCount;
-	uint8_t errorList[256];
+	uint16_t tempReg;					// Raw temperature MSB:LSB, see ds3231GetTemperature
+	bool tempValid;						// tempReg has been read at least once
+	
+	/* Error tracking */
+	uint8_t errorCounts[DS3231_NUM_ERRORS];						// Per kind, saturating
+	ds3231_error_event_t errorLogStorage[DS3231_ERROR_LOG_SIZE];
+	ring_buffer_t errorLog;										// Newest events, oldest dropped
+	
+	/* INT/SQW pin change interrupt */
+	volatile bool irqPending;			// Falling edge seen, ds3231Poll has work to do
+	volatile uint32_t irqTick;			// Timer ticks when the edge was seen
+	volatile bool irqFromEdge;			// irqTick is a real edge (not a retry), i.e. the RTC second boundary
+	uint32_t lastLatencyTicks;			// Edge to alarm callback, last alarm
+	uint32_t maxLatencyTicks;			// Edge to alarm callback, worst case
+	
+	/* Selective reads */
+	uint8_t verifyInterval;				// Full read + ctrl/alarm check every verifyInterval polls
+	uint8_t pollsSinceVerify;
+	bool forceVerify;					// Next poll does a full check (set after an I2C error)
+	uint32_t bytesSaved;				// Bus bytes saved by selective polls since init
+	
+	/* 1Hz tick mode */
+	bool tickMode;						// INT/SQW is a 1Hz square wave instead of the alarm interrupt
+	volatile uint8_t pendingTicks;		// Falling edges not yet handled by ds3231Poll
+	uint32_t tickTime;					// epoch_t advanced by the ticks
+	uint32_t lastResync;				// tickTime of the last register read
+	void (*tickCB)(void *objP);			// Run once per second in tick mode, time[] holds that second
+	void *tickObjP;
 } ds3231_t;
 
 /************************************************************************/
@@ -105,6 +143,22 @@ void ds3231SetAlarmCallback(ds3231_t *deviceP, const ALARM_NUMB alarm, void (*fu
   
 bool ds3231ReadRegisters(ds3231_t *deviceP, uint8_t respData[]);
 
+void ds3231SetVerifyInterval(ds3231_t *deviceP, const uint8_t polls);
+
+bool ds3231SetTickMode(ds3231_t *deviceP, const bool enable, void (*funcP)(void *objP), void *objP);
+
+uint8_t ds3231GetErrorCount(const ds3231_t *deviceP, const enum ds3231_errors_e error);
+
+bool ds3231PopErrorEvent(ds3231_t *deviceP, ds3231_error_event_t *eventP);
+
+void ds3231ClearErrors(ds3231_t *deviceP);
+
+bool ds3231GetTemperature(const ds3231_t *deviceP, int16_t *quarterCP);
+
+bool ds3231StartTempConversion(ds3231_t *deviceP);
+
 void ds3231Poll(ds3231_t *deviceP);
 
+void ds3231IntIsr(void);
+
 #endif /* RTC_H_ */
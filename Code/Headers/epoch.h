@@ -0,0 +1,62 @@
+/*
+ * epoch.h
+ *
+ * Created: 10/19/2026 5:12:40 PM
+ *  Author: plete
+ *
+ * Compact time: seconds since 2000-01-01 00:00:00 in a uint32_t (good until 2136). Converts to and from the
+ * DS3231 BCD time registers with small tables, shifts and multiplies; the only divisions are the handful needed
+ * to split seconds into days/hours/minutes. BCD conversion is valid for 2000-2099, 24 hour mode; epochFromBcd
+ * rejects anything else (e.g. a register read that came back as garbage) instead of indexing past its tables.
+ */
+
+
+#ifndef EPOCH_H_
+#define EPOCH_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "ds3231.h"
+
+#define EPOCH_SECS_PER_MIN		(60UL)
+#define EPOCH_SECS_PER_HOUR		(3600UL)
+#define EPOCH_SECS_PER_DAY		(86400UL)
+#define EPOCH_SECS_PER_WEEK		(604800UL)
+#define EPOCH_MAX_BCD			(3155759999UL)	// 2099-12-31 23:59:59
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef uint32_t epoch_t;
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+uint8_t epochBcdToBin(const uint8_t bcd);
+
+uint8_t epochBinToBcd(const uint8_t bin);
+
+bool epochFromBcd(const uint8_t time[TIME_UNITS_TOTAL], epoch_t *tP);
+
+void epochToBcd(const epoch_t t, uint8_t time[TIME_UNITS_TOTAL]);
+
+DAYS epochDayOfWeek(const epoch_t t);
+
+bool epochIsLeapYear(const uint8_t year);
+
+/* Shift a time by a signed number of seconds */
+static inline epoch_t epochAdd(const epoch_t t, const int32_t secs)
+{
+	return t + (uint32_t)secs;
+}
+
+/* Signed seconds from b to a. Valid while the two are less than ~68 years apart */
+static inline int32_t epochDiff(const epoch_t a, const epoch_t b)
+{
+	return (int32_t)(a - b);
+}
+
+#endif /* EPOCH_H_ */
@@ -0,0 +1,55 @@
+/*
+ * filter.h
+ *
+ * Created: 10/20/2026 3:06:52 AM
+ *  Author: plete
+ *
+ * Per channel fixed-point smoothing for slow sensor readings: outlier rejection -> sliding median -> EMA.
+ * A reading further than rejectBand from the current estimate is dropped, unless FILTER_REJECT_LIMIT readings in a
+ * row are, in which case the signal really moved and the filter restarts from there. Accepted readings go into a
+ * FILTER_MEDIAN_SIZE window kept sorted (one O(window) remove + insert per reading), so a single spike never
+ * reaches the output. The median then feeds an exponential average weighing each new value 1/2^emaShift.
+ * Values are in the channel's own integer units (e.g. C x100).
+ */
+
+
+#ifndef FILTER_H_
+#define FILTER_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FILTER_MEDIAN_SIZE		(3)		// Odd. Each extra slot costs 4 bytes per channel
+#define FILTER_REJECT_LIMIT		(2)		// Outliers in a row that are dropped before restarting on the new level
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef struct filter_s
+{
+	int16_t window[FILTER_MEDIAN_SIZE];		// Accepted readings in arrival order
+	int16_t sorted[FILTER_MEDIAN_SIZE];		// The same readings in ascending order
+	uint8_t count;							// Readings in the window
+	uint8_t next;							// window slot the next reading goes to (the oldest once full)
+	uint8_t emaShift;
+	uint8_t rejectRun;						// Outliers dropped in a row
+	uint16_t rejectBand;					// Max distance from the estimate. 0 disables rejection
+	uint16_t rejected;						// Outliers dropped since filterInit (saturates)
+	int32_t emaScaled;						// Estimate << emaShift
+} filter_t;
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+void filterInit(filter_t *filterP, const uint8_t emaShift, const uint16_t rejectBand);
+
+int16_t filterUpdate(filter_t *filterP, const int16_t value);
+
+int16_t filterGet(const filter_t *filterP);
+
+bool filterIsValid(const filter_t *filterP);
+
+#endif /* FILTER_H_ */
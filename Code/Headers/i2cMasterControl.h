@@ -24,4 +24,6 @@ bool i2cMasterTransmit(const uint8_t newAddr, uint8_t *payload, const uint8_t si
 void i2cMasterChangeAddr(const uint8_t newAddr);
 void resetI2c(void);
 bool returnBusy();
+bool i2cMasterPopError(uint8_t *errP);
+uint8_t i2cMasterGetState(uint8_t *addrP);
 #endif /* I2CMASTER_H_ */
\ No newline at end of file
@@ -14,15 +14,68 @@
 /************************************************************************/
 #include <atmel_start.h>
 #include <util/delay.h>
+#include <avr/sleep.h>
+#include <stdlib.h>
 //#include "DHT11.h"
 #include "timer.h"
-//#include "Moisture_Sensor.h"
+#include "Moisture_Sensor.h"
 #include "ds3231.h"
 #include "i2cMasterControl.h"
 #include "LCD.h"
 #include "mcp23017.h"
 #include "BME280_driver-master/bme280.h"
 #include "keypad.h"
+#include "atomic_access.h"
+#include "profiler.h"
+#include "watchdog.h"
+#include "mem_stats.h"
+#include "boot.h"
+#include "alarm_mux.h"
+#include "soft_clock.h"
+#include "bme_acq.h"
+#include "climate.h"
+#include "bme_profile.h"
+#include "adaptive_sched.h"
+#include "adc_engine.h"
+#include "filter.h"
+
+/* Watchdog deadlines */
+#define WDG_MAIN_LOOP_DEADLINE_MS		(2000)
+#define WDG_DISPLAY_DEADLINE_MS			(150000)	// Alarm 2 fires once a minute
+#define WDG_USER_INPUT_DEADLINE_MS		(45000)
+#define KEY_TIMEOUT_MS					(30000)		// readDigit gives up after this long
+
+#define BME_NUM_SENSORS					(2)			// BME280_I2C_ADDR_PRIM and BME280_I2C_ADDR_SEC
+#define ENV_PAGE_OFF					(0xFF)		// Environment page not showing
+
+/* BME280 adaptive sampling: 15s while something happens, up to 90s while flat. Channel units are x100 */
+#define BME_SCHED_MIN_MS				(15000)
+#define BME_SCHED_MAX_MS				(90000)
+#define BME_TEMP_DEAD_BAND				(10)		// 0.1 C
+#define BME_TEMP_SLOPE_PER_MIN			(50)		// 0.5 C/min
+#define BME_HUM_DEAD_BAND				(50)		// 0.5 %RH
+#define BME_HUM_SLOPE_PER_MIN			(200)		// 2 %RH/min
+
+/* Soil moisture: raw single conversion bounds until calibrated (full ADC span) and sampling, in per mille */
+#define SOIL_CAL_WET_RAW				(0)
+#define SOIL_CAL_DRY_RAW				(1023)
+#define SOIL_SCHED_MIN_MS				(30000)
+#define SOIL_SCHED_MAX_MS				(600000)	// Soil dries out over hours, watering shows within a minute
+#define SOIL_DEAD_BAND					(5)			// 0.5 %
+#define SOIL_SLOPE_PER_MIN				(20)		// 2 %/min
+
+/* Display smoothing: median of 3 + EMA, readings further than the band from the estimate are dropped as spikes */
+#define BME_TEMP_REJECT_BAND			(200)		// 2 C between samples
+#define BME_HUM_REJECT_BAND				(1000)		// 10 %RH
+#define BME_FILTER_SHIFT				(1)
+#define SOIL_REJECT_BAND				(100)		// 10 %
+#define SOIL_FILTER_SHIFT				(1)
+#define RTC_TEMP_REJECT_BAND			(300)		// 3 C, the DS3231 reads in 0.25 C steps
+#define RTC_TEMP_FILTER_SHIFT			(2)
+
+/* Night mode: daily software alarms blank the LCD overnight. Any key shows it again until the next night */
+#define DISPLAY_OFF_HOUR				(22)
+#define DISPLAY_ON_HOUR					(7)
 
 /************************************************************************/
 /*							Public Interfaces    	                    */
@@ -30,11 +83,17 @@
 
 void setUpdateFlag();
 
+#ifdef RTC_TICK_MODE
+void rtcTick(void *objP);
+#endif
+
 void printTime(lcd_t *lcdP, ds3231_t *ds3231P);
 
 void printSymbols(lcd_t *lcd);
 
-void printBMEdata(lcd_t *lcd, struct bme280_data *comp_data);
+void printBMEdata(lcd_t *lcd, const bme_display_t *dispP);
+
+void printRtcTemperature(lcd_t *lcdP, ds3231_t *ds3231P);
 
 uint8_t initBME(struct bme280_dev *sensor, int8_t (*user_i2c_read)(uint8_t, uint8_t*, uint32_t, void*),
 				int8_t (*user_i2c_write)(uint8_t, uint8_t*, uint32_t, void*),
@@ -46,6 +105,20 @@ int8_t userI2cRead(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf
 
 void userDelayUs (uint32_t period, void *intf_ptr);
 
-int8_t getSensorDataForcedMode(lcd_t *lcd, struct bme280_dev *dev);
+void printMemStats(lcd_t *lcdP);
+
+void printBootTimes(lcd_t *lcdP);
+
+void printRtcLatency(lcd_t *lcdP, ds3231_t *ds3231P);
+
+void printEnvironment(lcd_t *lcdP, const uint8_t sensor);
+
+void printBmeProfile(lcd_t *lcdP, const bme_profile_t profile);
+
+void printSoilMoisture(lcd_t *lcdP, const soil_moisture_sensor_t *sensorP);
+
+#ifdef PROFILER_ENABLE
+void printDiagnostics(lcd_t *lcdP, const prof_section_t section);
+#endif
 
 #endif /* MAIN_H_ */
\ No newline at end of file
@@ -0,0 +1,42 @@
+/*
+ * mem_stats.h
+ *
+ * Created: 10/19/2026 2:48:20 PM
+ *  Author: plete
+ *
+ * RAM usage instrumentation. Before any startup code runs, everything between the end of .bss and the top of
+ * the stack is painted with MEM_STATS_PAINT. The stack high-water mark is found later by counting how much of
+ * the paint is still intact, so it catches the deepest point reached even if it happened in an ISR.
+ */
+
+
+#ifndef MEM_STATS_H_
+#define MEM_STATS_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdint.h>
+
+#define MEM_STATS_PAINT			(0xC5)
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef struct mem_stats_s
+{
+	uint16_t staticBytes;		// .data + .bss
+	uint16_t freeNow;			// Bytes between end of .bss and current SP
+	uint16_t minFree;			// Untouched paint: smallest free stack seen since reset
+} mem_stats_t;
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+uint16_t memStatsMinFreeStack(void);
+
+uint16_t memStatsFreeNow(void);
+
+void memStatsGet(mem_stats_t *statsP);
+
+#endif /* MEM_STATS_H_ */
@@ -0,0 +1,75 @@
+/*
+ * profiler.h
+ *
+ * Created: 10/19/2026 11:05:37 AM
+ *  Author: plete
+ *
+ * Section profiler. PROF_ENTER/PROF_EXIT timestamp a section with Timer1 ticks (4us) and accumulate total
+ * time, worst case duration and call count. Sections may nest (e.g. I2C waits inside an LCD write), so totals
+ * are inclusive. PROF_RECORD adds a pass measured some other way, e.g. from a timer count.
+ * Define PROFILER_ENABLE in the project symbols to build it in; otherwise the macros expand to nothing and the
+ * table is not linked.
+ */
+
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/************************************************************************/
+/*							Enums Definition		 	                */
+/************************************************************************/
+typedef enum prof_section_e
+{
+	PROF_LOOP = 0,		// One main loop iteration. Max is the worst loop latency
+	PROF_LCD,			// LCD bus writes
+	PROF_I2C,			// Spinning on an I2C transfer
+	PROF_DELAY,			// Busy wait delays
+	PROF_RTC_POLL,		// ds3231Poll
+	PROF_ISR_TIMER,		// TIMER1_COMPA_vect
+	PROF_ISR_TWI,		// TWI_vect
+	PROF_IDLE,			// Idle sleep between main loop passes
+	PROF_NUM_SECTIONS
+} prof_section_t;
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef struct prof_stats_s
+{
+	uint32_t totalTicks;	// Time spent in section since last reset
+	uint32_t maxTicks;		// Longest single pass
+	uint16_t calls;			// Number of passes (saturates)
+	uint16_t loadPermille;	// totalTicks relative to time since last reset
+} prof_stats_t;
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+#ifdef PROFILER_ENABLE
+
+#define PROF_ENTER(section)		profilerEnter(section)
+#define PROF_EXIT(section)		profilerExit(section)
+#define PROF_RECORD(section, ticks)	profilerRecord(section, ticks)
+
+void profilerReset(void);
+void profilerEnter(const prof_section_t section);
+void profilerExit(const prof_section_t section);
+void profilerRecord(const prof_section_t section, const uint32_t ticks);
+bool profilerGetStats(const prof_section_t section, prof_stats_t *statsP);
+const char *profilerGetName(const prof_section_t section);
+
+#else
+
+#define PROF_ENTER(section)		((void)0)
+#define PROF_EXIT(section)		((void)0)
+#define PROF_RECORD(section, ticks)	((void)0)
+
+#endif /* PROFILER_ENABLE */
+
+#endif /* PROFILER_H_ */
@@ -0,0 +1,133 @@
+/*
+ * ring_buffer.h
+ *
+ * Created: 10/19/2026 9:12:04 AM
+ *  Author: plete
+ *
+ * Single-producer/single-consumer ring buffer used to hand data from an ISR to the main loop (or back).
+ * The producer only ever writes head and the consumer only ever writes tail. Both indices are 8 bits wide,
+ * so each access is a single load/store on the AVR and no critical section is needed.
+ */
+
+
+#ifndef RING_BUFFER_H_
+#define RING_BUFFER_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Keep the compiler from moving element copies across the index update. The host tests predefine it to add
+   preemption points */
+#if !defined(RING_BUFFER_BARRIER)
+#if defined(__GNUC__)
+#define RING_BUFFER_BARRIER()	__asm__ __volatile__ ("" ::: "memory")
+#else
+#define RING_BUFFER_BARRIER()
+#endif
+#endif
+
+/* Capacity must be a power of two no larger than this so head - tail always fits in a uint8_t */
+#define RING_BUFFER_MAX_CAPACITY	(128)
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef struct ring_buffer_s
+{
+	uint8_t *buffP;				// Element storage (capacity * elemSize bytes)
+	uint8_t elemSize;			// Size of one element in bytes
+	uint8_t mask;				// capacity - 1
+	volatile uint8_t head;		// Free running write index. Only written by producer
+	volatile uint8_t tail;		// Free running read index. Only written by consumer
+} ring_buffer_t;
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+
+/**
+*	Initialize a ring buffer over caller provided storage. Must be called before the producer is enabled.
+*	@param	rbP: ring buffer instance
+*	@param	storageP: element storage of at least capacity * elemSize bytes
+*	@param	elemSize: size of one element in bytes
+*	@param	capacity: number of elements. power of two, [1, RING_BUFFER_MAX_CAPACITY]
+*/
+static inline void ringBufferInit(ring_buffer_t *rbP, void *storageP, const uint8_t elemSize, const uint8_t capacity)
+{
+	rbP->buffP = (uint8_t *)storageP;
+	rbP->elemSize = elemSize;
+	rbP->mask = capacity - 1;
+	rbP->head = 0;
+	rbP->tail = 0;
+}
+
+/* Number of elements waiting to be consumed */
+static inline uint8_t ringBufferCount(const ring_buffer_t *rbP)
+{
+	return (uint8_t)(rbP->head - rbP->tail);
+}
+
+static inline bool ringBufferIsEmpty(const ring_buffer_t *rbP)
+{
+	return rbP->head == rbP->tail;
+}
+
+static inline bool ringBufferIsFull(const ring_buffer_t *rbP)
+{
+	return ringBufferCount(rbP) > rbP->mask;
+}
+
+/* Producer side: copy one element in. Returns false (element dropped) if the buffer is full */
+static inline bool ringBufferPush(ring_buffer_t *rbP, const void *elemP)
+{
+	uint8_t head = rbP->head;
+
+	if ((uint8_t)(head - rbP->tail) > rbP->mask)
+		return false;
+
+	uint8_t *slotP = rbP->buffP + (uint8_t)(head & rbP->mask) * rbP->elemSize;
+	for (uint8_t i = 0; i < rbP->elemSize; i++)
+		slotP[i] = ((const uint8_t *)elemP)[i];
+
+	RING_BUFFER_BARRIER();		// element must be stored before it is published
+	rbP->head = head + 1;
+	return true;
+}
+
+/* Consumer side: copy the oldest element out without removing it. Returns false if empty */
+static inline bool ringBufferPeek(const ring_buffer_t *rbP, void *elemP)
+{
+	uint8_t tail = rbP->tail;
+
+	if (rbP->head == tail)
+		return false;
+
+	RING_BUFFER_BARRIER();		// read head before the element it publishes
+	const uint8_t *slotP = rbP->buffP + (uint8_t)(tail & rbP->mask) * rbP->elemSize;
+	for (uint8_t i = 0; i < rbP->elemSize; i++)
+		((uint8_t *)elemP)[i] = slotP[i];
+
+	return true;
+}
+
+/* Consumer side: copy the oldest element out and release its slot. Returns false if empty */
+static inline bool ringBufferPop(ring_buffer_t *rbP, void *elemP)
+{
+	if (!ringBufferPeek(rbP, elemP))
+		return false;
+
+	RING_BUFFER_BARRIER();		// element must be copied before the slot is handed back
+	rbP->tail = rbP->tail + 1;
+	return true;
+}
+
+/* Consumer side: drop everything currently queued */
+static inline void ringBufferFlush(ring_buffer_t *rbP)
+{
+	rbP->tail = rbP->head;
+}
+
+#endif /* RING_BUFFER_H_ */
@@ -0,0 +1,47 @@
+/*
+ * soft_clock.h
+ *
+ * Created: 10/19/2026 6:03:27 PM
+ *  Author: plete
+ *
+ * Software seconds clock. Latches the RTC time whenever the DS3231 is read and advances it from the millisecond
+ * timebase in between, so anyone can get the current time (with seconds) without touching the I2C bus. Syncs
+ * taken on an alarm edge are exact second boundaries; the millisecond timer's drift against the RTC is measured
+ * between two of those and corrected for from then on.
+ */
+
+
+#ifndef SOFT_CLOCK_H_
+#define SOFT_CLOCK_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "epoch.h"
+
+#define SOFT_CLOCK_MAX_PPM			(5000)		// Anything past 0.5% is a time change, not drift
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef struct soft_clock_stats_s
+{
+	int16_t driftPpm;			// Millisecond timer vs RTC. Positive: timer runs fast
+	int16_t lastErrorMs;		// Predicted minus RTC time at the last sync
+	uint16_t syncs;				// Number of syncs (saturates)
+} soft_clock_stats_t;
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+void softClockSync(const epoch_t rtcTime, const uint32_t syncMs, const bool exact);
+
+bool softClockIsValid(void);
+
+epoch_t softClockNow(void);
+
+void softClockGetStats(soft_clock_stats_t *statsP);
+
+#endif /* SOFT_CLOCK_H_ */
@@ -9,6 +9,8 @@
 #define clockCyclesToMicroseconds(a) ( (a) / clockCyclesPerMicrosecond() )
 #define microsecondsToClockCycles(a) ( (a) * clockCyclesPerMicrosecond() )
 #define MAX_INT32_VAL	0xFFFFFFFF
+#define TICKS_PER_MILLISECOND		(250)	// Timer1 ticks at F_CPU / 64
+#define ticksToMicroseconds(a)		( (a) * 4 )
 
 #ifndef TIMER_H_
 #define TIMER_H_
@@ -24,7 +26,9 @@
 void startMillisTimer();
 void stopMillisTimer();
 void updateMillis();
+void advanceMillisTimer(const uint8_t ticks);
 uint32_t getMillis();
+uint32_t getTicks();
 void milli_delay(uint32_t milliseconds);
 void micro_delay(uint32_t micro);
 
@@ -0,0 +1,65 @@
+/*
+ * watchdog.h
+ *
+ * Created: 10/19/2026 1:14:48 PM
+ *  Author: plete
+ *
+ * Watchdog supervisor. The hardware watchdog runs in interrupt + reset mode with a ~1s period. Every period
+ * the WDT ISR checks that each enabled task has checked in within its own deadline and, if so, re-arms the
+ * interrupt. On a miss it records the task and the I2C driver state in .noinit RAM, runs the fail-safe
+ * callback and lets the next time-out reset the MCU. A hang with interrupts masked resets the same way,
+ * just without a recorded task.
+ */
+
+
+#ifndef WATCHDOG_H_
+#define WATCHDOG_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#define WDG_UNKNOWN_TASK		(0xFF)
+
+/************************************************************************/
+/*							Enums Definition		 	                */
+/************************************************************************/
+typedef enum wdg_task_e
+{
+	WDG_TASK_MAIN_LOOP = 0,		// Main loop is still iterating
+	WDG_TASK_DISPLAY,			// Alarm driven display refresh is still happening
+	WDG_TASK_USER_INPUT,		// A key was read while the user is being prompted
+	WDG_NUM_TASKS
+} wdg_task_t;
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef struct wdg_reset_cause_s
+{
+	uint8_t task;			// wdg_task_t that missed its deadline or WDG_UNKNOWN_TASK
+	uint8_t i2cState;		// I2C driver FSM state at the time of the miss
+	uint8_t i2cAddr;		// Slave address of the last I2C transfer
+	uint8_t resetCount;		// Watchdog resets since power on
+} wdg_reset_cause_t;
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+void watchdogInit(void);
+
+void watchdogEnableTask(const wdg_task_t task, const uint32_t deadlineMs);
+
+void watchdogDisableTask(const wdg_task_t task);
+
+void watchdogCheckIn(const wdg_task_t task);
+
+void watchdogSetFailSafeCB(void (*funcP)(void));
+
+bool watchdogGetResetCause(wdg_reset_cause_t *causeP);
+
+void watchdogIsr(void);
+
+#endif /* WATCHDOG_H_ */
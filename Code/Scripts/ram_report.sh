@@ -0,0 +1,51 @@
+#!/bin/sh
+#
+# ram_report.sh
+#
+# Created: 10/19/2026 3:20:12 PM
+#  Author: plete
+#
+# Post-build RAM report: .data/.bss per object file, the largest RAM symbols and the image total checked
+# against a budget. Exits non-zero when the budget is blown so the build fails before the board does.
+#
+# usage:   ram_report.sh <elf> [object dir] [budget bytes]
+# Atmel Studio post-build event:
+#          sh "$(SolutionDir)Scripts\ram_report.sh" "$(OutputDirectory)\$(OutputFileName).elf" "$(OutputDirectory)"
+#
+
+ELF="$1"
+OBJDIR="${2:-$(dirname "$ELF")}"
+# 2KB SRAM minus what the stack needs at its deepest (see memStatsMinFreeStack on the 'C' screen)
+BUDGET="${3:-1536}"
+SIZE="${AVR_SIZE:-avr-size}"
+NM="${AVR_NM:-avr-nm}"
+TOP=10
+
+if [ ! -f "$ELF" ]; then
+	echo "ram_report: no such file '$ELF'" >&2
+	exit 2
+fi
+
+echo "RAM per module (bytes)"
+printf "%6s %6s %6s  %s\n" data bss total object
+find "$OBJDIR" -name '*.o' -exec "$SIZE" -B {} + | awk 'NR > 1 && ($2 + $3) > 0 {
+	data = $2; bss = $3
+	for (i = 0; i < 5; i++)		# Drop the size columns, the rest is the object path even with spaces in it
+		sub(/^[ \t]*[^ \t]+[ \t]+/, "")
+	printf "%6d %6d %6d  %s\n", data, bss, data + bss, $0
+}' | sort -k3 -n -r
+
+echo
+echo "Largest RAM symbols"
+"$NM" -S -t d --size-sort -r "$ELF" | awk -v top="$TOP" 'tolower($3) == "b" || tolower($3) == "d" {
+	if (n++ < top) printf "%6d  %s\n", $2, $4
+}'
+
+TOTAL=$("$SIZE" -B "$ELF" | awk 'NR == 2 { print $2 + $3 }')
+echo
+echo "data+bss: $TOTAL / $BUDGET bytes"
+if [ "$TOTAL" -gt "$BUDGET" ]; then
+	echo "ram_report: RAM budget exceeded by $((TOTAL - BUDGET)) bytes" >&2
+	exit 1
+fi
+exit 0
@@ -12,6 +12,7 @@
 
 #include "LCD.h"
 #include "timer.h"
+#include "profiler.h"
 #include "stdbool.h"
 
 #define INSTRUCTION_FLAG			0x00
@@ -57,6 +58,7 @@
 #define _5x8_FONT					0x00
 
 #define LINE1_ADDR_OFFSET			0x40
+#define POWER_ON_DELAY_MS			50
 
 /************************************************************************/
 /*                      Private Function Declaration                    */
@@ -67,10 +69,14 @@ static uint8_t lcdRead(lcd_t *lcdP, uint8_t rsFlag);
 /************************************************************************/
 /*                      Public Functions Implementations                */
 /************************************************************************/
-void lcdInit(lcd_t *lcdP, mcp23017_t *ioExpander, volatile uint8_t *ctrlDdr, volatile uint8_t *ctrlPort,
-			 uint8_t rsPin, uint8_t rwPin, uint8_t enPin, bool lines, bool font)
+/**
+*	Power-on half of the LCD init: latch the pins and configuration and start the power-on clock. Doesn't touch the
+*	bus, so it can run first thing at boot and the >15ms power-on wait overlaps with the rest of the start up.
+*	lcdInitComplete must be called before any other lcd function.
+*/
+void lcdPowerOn(lcd_t *lcdP, mcp23017_t *ioExpander, volatile uint8_t *ctrlDdr, volatile uint8_t *ctrlPort,
+				uint8_t rsPin, uint8_t rwPin, uint8_t enPin, bool lines, bool font)
 {
-	/*bool status = false;*/
 	// Set Direction of Ctrl port Pins to output with value 0
 	*ctrlDdr |= (1 << rsPin) | (1 << rwPin) | (1 << enPin);
 	*ctrlPort &= ~((1 << rsPin) | (1 << rwPin) | (1 << enPin));
@@ -82,18 +88,25 @@ void lcdInit(lcd_t *lcdP, mcp23017_t *ioExpander, volatile uint8_t *ctrlDdr, vol
 	lcdP->rwPin = rwPin;
 	lcdP->enPin = enPin;
 	lcdP->ioExpander = ioExpander;
-	
+	lcdP->functionSet = _8_BIT_DATA | (lines ? _2_LINE_MODE : _1_LINE_MODE ) | (font ? _5x11_FONT : _5x8_FONT);
+	lcdP->powerOnMs = getMillis();
+}
+
+/* Bus half of the LCD init. Only waits for whatever is left of the power-on delay. Expander must be initialized */
+void lcdInitComplete(lcd_t *lcdP)
+{
 	mcp23017SetPortDir(lcdP->ioExpander, MCP23017_PORTB, 0); // set port b direction to output for lcd
 
 	/*** Process to initialize LCM Pg 16 of LCD1602A data sheet ***/
-    milli_delay(50);						// power on delay for > 15ms 
+	uint32_t elapsed = getMillis() - lcdP->powerOnMs;
+	if (elapsed < POWER_ON_DELAY_MS)
+		milli_delay(POWER_ON_DELAY_MS - elapsed);		// power on delay for > 15ms
 	// Send three Function Set (8-bit data length) 
 	lcdWrite(lcdP, FUNCTION_SET | _8_BIT_DATA | _1_LINE_MODE | _5x8_FONT, INSTRUCTION_FLAG);
 	milli_delay(5);							// Wait for > 4.1ms
 	lcdWrite(lcdP, FUNCTION_SET | _8_BIT_DATA | _1_LINE_MODE | _5x8_FONT, INSTRUCTION_FLAG);
 	micro_delay(150);						// Wait for > 100uS
 	lcdWrite(lcdP, FUNCTION_SET | _8_BIT_DATA | _1_LINE_MODE | _5x8_FONT, INSTRUCTION_FLAG);
-	lcdP->functionSet = _8_BIT_DATA | (lines ? _2_LINE_MODE : _1_LINE_MODE ) | (font ? _5x11_FONT : _5x8_FONT);
 	
 	// Set data length, # lines, and font. # lines and font cant be changed after this point
 	lcdWrite(lcdP, FUNCTION_SET | lcdP->functionSet, INSTRUCTION_FLAG);	// 0x38
@@ -113,6 +126,14 @@ void lcdInit(lcd_t *lcdP, mcp23017_t *ioExpander, volatile uint8_t *ctrlDdr, vol
 	
 }
 
+/* Blocking init: power on and complete in one go */
+void lcdInit(lcd_t *lcdP, mcp23017_t *ioExpander, volatile uint8_t *ctrlDdr, volatile uint8_t *ctrlPort,
+			 uint8_t rsPin, uint8_t rwPin, uint8_t enPin, bool lines, bool font)
+{
+	lcdPowerOn(lcdP, ioExpander, ctrlDdr, ctrlPort, rsPin, rwPin, enPin, lines, font);
+	lcdInitComplete(lcdP);
+}
+
 /**
 *	Clear all the display data in all DDRAM address
 *	Set address counter to 00H
@@ -310,6 +331,7 @@ uint8_t lcdReadData(lcd_t *lcdP)
 /* Write data to lcd */
 static void lcdWrite(lcd_t *lcdP, unsigned char data, uint8_t rsFlag)
 {
+	PROF_ENTER(PROF_LCD);
 	if (rsFlag)
 		*lcdP->ctrlPort |= (1 << lcdP->rsPin);			//it is data rather than an instruction
 	else
@@ -322,6 +344,7 @@ static void lcdWrite(lcd_t *lcdP, unsigned char data, uint8_t rsFlag)
 	*lcdP->ctrlPort |= (1 << lcdP->enPin);				//set E to 1 (see Figure 1)
 	micro_delay(1);										// need to be on for > 230ns
 	*lcdP->ctrlPort &= ~(1 << lcdP->enPin);				// set E to 0 to generate a falling edge
+	PROF_EXIT(PROF_LCD);
 }
 
 /* Read data to lcd */
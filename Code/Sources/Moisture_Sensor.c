@@ -10,9 +10,8 @@
 /************************************************************************/ 
 #include "Moisture_Sensor.h"
 #include "adc_basic.h"
-#include "LCD.h"
-#include "stdio.h"
 #include "timer.h"
+#include <avr/io.h>
 
 
 
@@ -29,24 +28,20 @@
 
 
 #define SENS_ADC_CHAN_NUM			(0x00)
+#define ADC_MAX_RAW					(1023)		// 10-bit conversion
 
-static bool sampleFlag = false;
-static bool alarmTrigFlag = false;
+#if (SOIL_SAMPLE_COUNT * (ADC_MAX_RAW << SOIL_OVERSAMPLE_LOG4)) > 0xFFFF
+#error "SOIL_SAMPLE_COUNT samples at SOIL_OVERSAMPLE_LOG4 overflow the uint16_t raw sum"
+#endif
 
-/* Upper and lower bound for soil moisture value */
-static volatile double soilWetVal = 0; // lower bound
-static volatile double soilDryVal = 0; // upper bound
-static volatile double oldRange = 0; // Moisture Range
+static bool alarmTrigFlag = false;
 
-/* Water Content Symbol */
-unsigned char soilSenSymb[] = {0x0E,0x11,0x11,0x1F,0x11,0x11,0x0E,0x00};
-uint8_t soilSenSymLoc = 5;
 /************************************************************************/
 /*                      Private Function Declaration                    */
 /************************************************************************/
 
-static adc_irq_cb_t adcReadCompCB();
-static void printSoilMoist(uint8_t moisture);
+static void adcReadCompCB(void *objP, const uint16_t *samplesP, const uint8_t count);
+static uint16_t sumToPermille(const soil_moisture_sensor_t *sensorP, const uint16_t sum);
 static void waitForBtnPress();
 
 
@@ -70,32 +65,62 @@ void soilSenPwrRelay(bool relayState)
 }
 
 /* Initialize moisture sensor object's data members */
-void soilSensInit(soil_moisture_sensor_t *sensorP)
+void soilSensInit(soil_moisture_sensor_t *sensorP, soil_sens_cb_t funcP, void *objP)
 {
-	//sensorP->state = MS_UNCALIBRATED;
-	//sensorP->sampleNum = sensorP->timeStamp = 0;
-	//sensorP->calibrateFlag = false;
-	///* Configure pin DDRx as output low for relay control */
-	//RELAY_DDR |= (1 << RELAY_OUTOUT_PIN);
-	//soilSenPwrRelay(false);
-	///* Register callback for ADC sensor reading completion */
-	//ADC_0_register_callback(adcReadCompCB);
-	//
+	sensorP->state = MS_UNCALIBRATED;
+	sensorP->sampleNum = 0;
+	sensorP->timeStamp = 0;
+	sensorP->calibrateFlag = false;
+	sensorP->moisture = sensorP->rawSum = 0;
+	sensorP->wetSum = sensorP->drySum = 0;
+	sensorP->rangeRecipQ16 = 0;
+	sensorP->funcP = funcP;
+	sensorP->objP = objP;
+	
+	/* Configure pin DDRx as output low for relay control */
+	RELAY_DDR |= (1 << RELAY_OUTOUT_PIN);
+	soilSenPwrRelay(false);
+	
+	/* ADC burst handed back to adcReadCompCB once all samples are in */
+	sensorP->job.channel = SENS_ADC_CHAN_NUM;
+	sensorP->job.count = SOIL_SAMPLE_COUNT;
+	sensorP->job.periodUs = 0;
+	sensorP->job.oversampleLog4 = SOIL_OVERSAMPLE_LOG4;
+	sensorP->job.quiet = true;		// Convert in ADC Noise Reduction sleep
+	sensorP->job.samplesP = sensorP->samples;
+	sensorP->job.funcP = adcReadCompCB;
+	sensorP->job.objP = sensorP;
+	sensorP->job.busy = false;
+	
 	///* Configure Calibration Button */
 	//CAL_BTN_DDR &= ~(1 << CAL_BTN_PIN_NUM); // Intput pin 
-	///* Build and print water content symbol*/
-	//lcdBuildSym(soilSenSymLoc,soilSenSymb);
-	//lcdSetDDRAMAdrr(1,11);
-	//lcdWriteSymbol(soilSenSymLoc);
-	//lcdWriteString("00%");
 }
 
-/* Retrieve sensor's soil moisure reading */
-double soilSenGetMoisture(soil_moisture_sensor_t *sensorP)
+/* Retrieve sensor's soil moisure reading, in per mille: 0 at the wet bound, SOIL_FULL_SCALE at the dry bound */
+uint16_t soilSenGetMoisture(soil_moisture_sensor_t *sensorP)
 {
 	return sensorP->moisture;
 }
 
+/**
+*	Set the raw ADC readings (single conversion, 0-1023) for the wettest and driest soil. The reciprocal of the
+*	range is worked out here once so a reading only costs one multiply. Returns false, keeping the previous
+*	calibration, if dry is not above wet
+*/
+bool soilSensSetCalibration(soil_moisture_sensor_t *sensorP, const uint16_t wetRaw, const uint16_t dryRaw)
+{
+	if (dryRaw <= wetRaw || dryRaw > ADC_MAX_RAW)
+		return false;
+	
+	sensorP->wetSum = (wetRaw * SOIL_SAMPLE_COUNT) << SOIL_OVERSAMPLE_LOG4;
+	sensorP->drySum = (dryRaw * SOIL_SAMPLE_COUNT) << SOIL_OVERSAMPLE_LOG4;
+	uint16_t range = sensorP->drySum - sensorP->wetSum;
+	sensorP->rangeRecipQ16 = (((uint32_t)SOIL_FULL_SCALE << 16) + range / 2) / range;
+	if (sensorP->state == MS_UNCALIBRATED)
+		sensorP->state = MS_IDLE;
+	return true;
+}
+
 /* Calibrate the upper and lower bound for soil moisture */
 void soilSenCalibrate(soil_moisture_sensor_t *sensorP)
 {
@@ -174,35 +199,30 @@ void soilSenCalibrate(soil_moisture_sensor_t *sensorP)
 	//return;
 }
 
-void readSens(soil_moisture_sensor_t *sensorP)
+/**
+*	Power the sensor and start a reading without waiting for it. soilSensService takes it through the settle
+*	time and the ADC burst; the result is stored when the burst completes. Returns false if a reading is running
+*/
+bool readSens(soil_moisture_sensor_t *sensorP)
 {
+	if (sensorP->state == MS_STABLILIZING || sensorP->state == MS_READ)
+		return false;
+	
 	soilSenPwrRelay(true);
-	milli_delay(10);
-	/* Start to read */
-	for (int i = 0; i < 10; i++)
-	{
-		/* Initiate an ADC Conversion */
-		ADC_0_start_conversion(SENS_ADC_CHAN_NUM);
-		sensorP->moisture += ADC_0_get_conversion(SENS_ADC_CHAN_NUM);
-	}
-	/* Turn off Sensor */
-	soilSenPwrRelay(false);
-	/* Take the average of the readings */
+	sensorP->timeStamp = getMillis();
+	sensorP->state = MS_STABLILIZING;
+	return true;
+}
 
-	sensorP->moisture /= 5;
-	
-	/* If we are calibrating, don't print and leave moisture value as an average */
-	if(sensorP->calibrateFlag){return;}
-	
-	/* Convert average moisture calculated to a value between 0-100 */
-	/* If value is closer to 0, soil is moist. If value is closer to 100, soil is dry */
-	double newMin = 0, newMax = 100;
-	double newRange = newMax - newMin; /* 0-100 */
-	sensorP->moisture = ((sensorP->moisture-soilWetVal)/oldRange)*(newRange) + newMin;
+/* Advance a reading started by readSens. Call every main loop pass, together with adcEngineService */
+void soilSensService(soil_moisture_sensor_t *sensorP)
+{
+	if (sensorP->state != MS_STABLILIZING || getMillis() - sensorP->timeStamp < SOIL_STABILIZE_MS)
+		return;
 	
-	/* Print Moisture on LCD */
-	printSoilMoist((uint8_t)sensorP->moisture);
-
+	/* Queue full: try again on the next pass */
+	if (adcEngineQueue(&sensorP->job))
+		sensorP->state = MS_READ;
 }
 
 /************************************************************************/
@@ -210,21 +230,42 @@ void readSens(soil_moisture_sensor_t *sensorP)
 /************************************************************************/
 
 
-/* Callback function to indicate a sampling of the ADC has been complete */
-static adc_irq_cb_t adcReadCompCB()
+/* ADC burst complete: runs from adcEngineService in the main loop, not from the ISR */
+static void adcReadCompCB(void *objP, const uint16_t *samplesP, const uint8_t count)
 {
-	sampleFlag = true;
+	soil_moisture_sensor_t *sensorP = (soil_moisture_sensor_t *)objP;
+	
+	/* Turn off Sensor */
+	soilSenPwrRelay(false);
+	
+	/* The calibration bounds are sums too, so no division by the sample count is needed */
+	uint16_t sum = 0;
+	for (uint8_t i = 0; i < count; i++)
+		sum += samplesP[i];
+	sensorP->rawSum = sum;
+	
+	/* While calibrating only the raw sum is wanted */
+	if (!sensorP->calibrateFlag && sensorP->rangeRecipQ16 != 0)
+		sensorP->moisture = sumToPermille(sensorP, sum);
+	sensorP->state = sensorP->rangeRecipQ16 != 0 ? MS_READ_COMPLETE : MS_UNCALIBRATED;
+	
+	if (sensorP->funcP != NULL)
+		sensorP->funcP(sensorP->objP, sensorP);
 }
 
-static void printSoilMoist(uint8_t moisture)
+/**
+*	Scale a raw sum onto 0..SOIL_FULL_SCALE, clamped to the calibration bounds. If value is closer to 0, soil is
+*	moist. The Q16 reciprocal keeps it to one 16x32 multiply; rounding the reciprocal costs less than
+*	(drySum - wetSum) / 131072, i.e. under 0.32 per mille at the full 12-bit span
+*/
+static uint16_t sumToPermille(const soil_moisture_sensor_t *sensorP, const uint16_t sum)
 {
-	char buff[20];
-	/* Print moisture */
-	lcdSetDDRAMAdrr(1,12);
-	if (moisture < 10){lcdWriteString("0");}
-	snprintf(buff,20,"%d", moisture);
-	lcdWriteString(buff);
-	lcdWriteString("%");	
+	if (sum <= sensorP->wetSum)
+		return 0;
+	if (sum >= sensorP->drySum)
+		return SOIL_FULL_SCALE;
+	
+	return (uint16_t)(((uint32_t)(sum - sensorP->wetSum) * sensorP->rangeRecipQ16 + 0x8000) >> 16);
 }
 
 /* Wait for button to have been pressed for at least 25ms */
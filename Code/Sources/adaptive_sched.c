@@ -0,0 +1,80 @@
+/*
+ * adaptive_sched.c
+ *
+ * Created: 10/20/2026 12:37:02 AM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "adaptive_sched.h"
+
+#define MS_PER_MIN			(60000UL)
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/* Start at the shortest interval, with the first sample due right away */
+void adaptSchedInit(adapt_sched_t *schedP, const uint32_t minMs, const uint32_t maxMs, const uint16_t deadBand,
+					const uint16_t slopePerMin)
+{
+	schedP->minMs = minMs;
+	schedP->maxMs = maxMs < minMs ? minMs : maxMs;
+	schedP->deadBand = deadBand;
+	schedP->slopePerMin = slopePerMin;
+	schedP->intervalMs = 0;
+	schedP->startMs = schedP->valueMs = 0;
+	schedP->hasValue = false;
+}
+
+/* True once the current interval has run out since the last sample was started */
+bool adaptSchedDue(const adapt_sched_t *schedP, const uint32_t nowMs)
+{
+	return nowMs - schedP->startMs >= schedP->intervalMs;
+}
+
+/**
+*	Record that a sample was started. Called at the trigger rather than when the value comes in, so a read that
+*	fails is simply retried one interval later instead of on every pass.
+*/
+void adaptSchedStarted(adapt_sched_t *schedP, const uint32_t nowMs)
+{
+	schedP->startMs = nowMs;
+	if (schedP->intervalMs < schedP->minMs)
+		schedP->intervalMs = schedP->minMs;
+}
+
+/* Feed the value of the last started sample and adapt the interval to how fast the channel moves */
+void adaptSchedUpdate(adapt_sched_t *schedP, const int16_t value)
+{
+	if (schedP->hasValue)
+	{
+		uint16_t delta = value > schedP->lastValue ? (uint16_t)(value - schedP->lastValue) :
+						 (uint16_t)(schedP->lastValue - value);
+		uint32_t elapsedMs = schedP->startMs - schedP->valueMs;
+		uint32_t slope = elapsedMs ? (uint32_t)delta * MS_PER_MIN / elapsedMs : 0;
+
+		if (slope > schedP->slopePerMin)
+		{
+			schedP->intervalMs = schedP->minMs;
+		}
+		else if (delta <= schedP->deadBand)
+		{
+			schedP->intervalMs = schedP->intervalMs > schedP->maxMs / 2 ? schedP->maxMs : schedP->intervalMs * 2;
+		}
+		else
+		{
+			/* Scale down to the interval that would have kept this change inside the dead-band. A slope measured
+			   over a long interval understates a step, so this also catches events the slope limit misses */
+			schedP->intervalMs = (schedP->intervalMs / delta) * schedP->deadBand;
+			if (schedP->intervalMs < schedP->minMs)
+				schedP->intervalMs = schedP->minMs;
+		}
+	}
+
+	schedP->lastValue = value;
+	schedP->valueMs = schedP->startMs;
+	schedP->hasValue = true;
+}
@@ -0,0 +1,235 @@
+/*
+ * adc_engine.c
+ *
+ * Created: 10/20/2026 1:52:40 AM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "adc_engine.h"
+#include "ring_buffer.h"
+#include "atomic_access.h"
+#include "adc_basic.h"
+#include "timer.h"
+#include <avr/io.h>
+#include <avr/sleep.h>
+
+#define ADC_MUX_MASK			(0x0F)
+#define ADC_TRIGGER_MASK		((1 << ADTS2) | (1 << ADTS1) | (1 << ADTS0))
+#define ADC_TRIGGER_TIMER0_A	((1 << ADTS1) | (1 << ADTS0))	// Timer/Counter0 compare match A
+#define TIMER0_CLOCK_BITS		((1 << CS01) | (1 << CS00))		// F_CPU / 64: 4us per count
+#define TIMER0_US_PER_COUNT		(4)
+#define ADC_ENGINE_MAX_DONE		(8)		// Every queued job plus the active one fits
+#define ADC_CLOCK_US			(8)		// F_CPU / 128
+/* Timer1 time lost per quiet conversion: it starts on the next ADC clock edge after sleep entry, so on average
+   half an ADC clock after it, then takes ADC_ENGINE_CONV_US. 27 ticks, within 4us of the real figure */
+#define QUIET_SLEEP_TICKS		((ADC_ENGINE_CONV_US + ADC_CLOCK_US / 2) / ticksToMicroseconds(1))
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+static adc_job_t *pendingStorage[ADC_ENGINE_MAX_JOBS];
+static adc_job_t *doneStorage[ADC_ENGINE_MAX_DONE];
+static ring_buffer_t pendingList;		// Produced by adcEngineQueue, consumed by the ISR (or with it masked)
+static ring_buffer_t doneList;			// Produced by the ISR, consumed by adcEngineService
+static adc_job_t *volatile activeP;		// Job the running conversion belongs to. NULL when the ADC is idle
+static uint16_t accumulator;			// Conversions summed so far for the sample being oversampled
+static uint8_t accumulated;				// Number of them. Both only touched by the ISR or with it masked
+static volatile uint8_t quietDone;		// Quiet conversions finished, counted by the ISR (wraps)
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+static void adcEngineIsr(void);
+static void startNextJob(void);
+static void restartConversion(const adc_job_t *jobP);
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/* Set up the job queues and take over the ADC interrupt callback. ADC_0_init must have run */
+void adcEngineInit(void)
+{
+	ringBufferInit(&pendingList, pendingStorage, sizeof(pendingStorage[0]), ADC_ENGINE_MAX_JOBS);
+	ringBufferInit(&doneList, doneStorage, sizeof(doneStorage[0]), ADC_ENGINE_MAX_DONE);
+	activeP = NULL;
+	ADC_0_register_callback(adcEngineIsr);
+}
+
+/**
+*	Queue a burst. The conversions start right away if the ADC is idle, otherwise after the jobs ahead of it.
+*	Returns false if the job is still busy, malformed or the queue is full.
+*/
+bool adcEngineQueue(adc_job_t *jobP)
+{
+	if (jobP->busy || jobP->count == 0 || jobP->samplesP == NULL ||
+		jobP->oversampleLog4 > ADC_ENGINE_MAX_OVERSAMPLE ||
+		(jobP->periodUs != 0 && (jobP->quiet || jobP->periodUs < ADC_ENGINE_MIN_PERIOD_US ||
+								 jobP->periodUs > ADC_ENGINE_MAX_PERIOD_US)))
+		return false;
+
+	jobP->taken = 0;
+	jobP->busy = true;
+	if (!ringBufferPush(&pendingList, &jobP))
+	{
+		jobP->busy = false;
+		return false;
+	}
+
+	/* The ISR also pops the pending list: keep it out while checking for an idle ADC */
+	ENTER_CRITICAL(Q);
+	if (activeP == NULL)
+		startNextJob();
+	EXIT_CRITICAL(Q);
+
+	return true;
+}
+
+/* Run the callbacks of finished jobs. Call every main loop pass */
+void adcEngineService(void)
+{
+	adc_job_t *jobP;
+
+	while (ringBufferPop(&doneList, &jobP))
+	{
+		/* Released first so the callback can queue the same job again */
+		jobP->busy = false;
+		if (jobP->funcP != NULL)
+			jobP->funcP(jobP->objP, jobP->samplesP, jobP->taken);
+	}
+}
+
+/* True while a conversion runs or a job waits to start or to be serviced */
+bool adcEngineIsBusy(void)
+{
+	return activeP != NULL || !ringBufferIsEmpty(&pendingList) || !ringBufferIsEmpty(&doneList);
+}
+
+/**
+*	True while a quiet job is converting: the next sleep should be adcEngineQuietSleep, which starts its next
+*	conversion. The caller must make sure no TWI transfer is in flight, the TWI clock stops in that mode too.
+*/
+bool adcEngineQuietPending(void)
+{
+	adc_job_t *jobP = activeP;
+	return jobP != NULL && jobP->quiet;
+}
+
+/**
+*	Sleep in ADC Noise Reduction mode, which starts the quiet job's next conversion, then put the sleep mode back
+*	to idle. Timer1 is halted until the wake-up, so getMillis is moved on by one conversion if it was the ADC that
+*	woke us. Another interrupt waking us first makes it off by up to one conversion time (112us) either way.
+*/
+void adcEngineQuietSleep(void)
+{
+	uint8_t done = quietDone;
+
+	set_sleep_mode(SLEEP_MODE_ADC);
+	sleep_mode();
+	set_sleep_mode(SLEEP_MODE_IDLE);
+
+	if (quietDone != done)
+		advanceMillisTimer(QUIET_SLEEP_TICKS);
+}
+
+/* Conversion count, resolution, per sample time and rate of a job, for reports. Quiet jobs add wake-up time */
+void adcEngineGetTiming(const adc_job_t *jobP, adc_timing_t *timingP)
+{
+	uint8_t perSample = 1 << (2 * jobP->oversampleLog4);
+	uint16_t convUs = jobP->periodUs ? jobP->periodUs : ADC_ENGINE_CONV_US;
+
+	timingP->conversions = (uint16_t)jobP->count * perSample;
+	timingP->bits = 10 + jobP->oversampleLog4;
+	timingP->sampleUs = (uint32_t)perSample * convUs;
+	timingP->burstUs = (uint32_t)timingP->conversions * convUs;
+	timingP->samplesPerSec = (uint16_t)(1000000UL / timingP->sampleUs);
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+/* ADC_vect callback: store the result and keep the burst going */
+static void adcEngineIsr(void)
+{
+	adc_job_t *jobP = activeP;
+	uint16_t sample = ADC;
+
+	if (jobP == NULL)
+		return;
+	if (jobP->quiet)
+		quietDone++;
+
+	/* Decimate: 4^n conversions summed and shifted right by n */
+	accumulator += sample;
+	accumulated++;
+	if (accumulated < (uint8_t)(1 << (2 * jobP->oversampleLog4)))
+	{
+		restartConversion(jobP);
+		return;
+	}
+
+	jobP->samplesP[jobP->taken] = accumulator >> jobP->oversampleLog4;
+	jobP->taken = jobP->taken + 1;
+	accumulator = 0;
+	accumulated = 0;
+	if (jobP->taken < jobP->count)
+	{
+		restartConversion(jobP);
+		return;
+	}
+
+	ringBufferPush(&doneList, &jobP);
+	startNextJob();
+}
+
+/* Point the ADC at the next pending job and start it, or park the ADC and Timer0. Interrupts must be masked */
+static void startNextJob(void)
+{
+	adc_job_t *jobP;
+
+	if (!ringBufferPop(&pendingList, &jobP))
+	{
+		activeP = NULL;
+		ADCSRA &= ~(1 << ADATE);
+		TCCR0B = 0;
+		return;
+	}
+
+	activeP = jobP;
+	accumulator = 0;
+	accumulated = 0;
+	ADMUX = (ADMUX & ~ADC_MUX_MASK) | (jobP->channel & ADC_MUX_MASK);
+
+	if (jobP->periodUs)
+	{
+		/* CTC: the first conversion starts one period from now, then one per period */
+		TCCR0B = 0;
+		TCCR0A = (1 << WGM01);
+		OCR0A = (uint8_t)(jobP->periodUs / TIMER0_US_PER_COUNT - 1);
+		TCNT0 = 0;
+		TIFR0 = (1 << OCF0A);
+		ADCSRB = (ADCSRB & ~ADC_TRIGGER_MASK) | ADC_TRIGGER_TIMER0_A;
+		ADCSRA |= (1 << ADATE);
+		TCCR0B = TIMER0_CLOCK_BITS;
+	}
+	else
+	{
+		ADCSRA &= ~(1 << ADATE);
+		TCCR0B = 0;
+		restartConversion(jobP);
+	}
+}
+
+/* Get the next conversion of the active job going */
+static void restartConversion(const adc_job_t *jobP)
+{
+	if (jobP->periodUs)
+		TIFR0 = (1 << OCF0A);		// Auto trigger fires on the flag's rising edge: re-arm it
+	else if (!jobP->quiet)
+		ADCSRA |= (1 << ADSC);
+	/* Quiet: entering ADC Noise Reduction sleep starts it */
+}
@@ -0,0 +1,295 @@
+/*
+ * alarm_mux.c
+ *
+ * Created: 10/19/2026 7:48:31 PM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "alarm_mux.h"
+#include "soft_clock.h"
+#include "ds3231_regs_and_utils.h"
+#include <stddef.h>
+
+#define FREE_SLOT			(0xFF)
+#define ID_SLOT_MASK		(0xFF)
+#define ID_GEN_SHIFT		(8)
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+typedef struct mux_alarm_s
+{
+	epoch_t when;
+	uint32_t periodS;				// 0 == one shot
+	uint16_t seq;					// Add order, breaks ties between alarms due at the same second
+	uint8_t heapPos;				// Index in heap[] or FREE_SLOT
+	uint8_t gen;					// Bumped each time the slot is freed, part of the id
+	void (*funcP)(void *objP);
+	void *objP;
+} mux_alarm_t;
+
+static ds3231_t *muxRtcP;
+static mux_alarm_t pool[ALARM_MUX_MAX_ALARMS];
+static uint8_t heap[ALARM_MUX_MAX_ALARMS];	// Pool indexes, heap[0] is the earliest
+static uint8_t heapSize;
+static uint16_t nextSeq;
+static bool hwArmed;
+static epoch_t hwWhen;						// What Alarm 1 is currently set to
+static bool dispatching;					// Callbacks running: Alarm 1 is reprogrammed once they are done
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+static bool isBefore(const uint8_t a, const uint8_t b);
+static void heapSwap(const uint8_t i, const uint8_t j);
+static void siftUp(uint8_t pos);
+static void siftDown(uint8_t pos);
+static void heapPush(const uint8_t slot);
+static void heapRemove(const uint8_t pos);
+static bool muxNow(epoch_t *nowP);
+static void dispatchDue(const epoch_t now);
+static void programHardware(void);
+static void hwAlarmCB(void *objP);
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/* Take over DS3231 Alarm 1. Drops any software alarm left from before */
+void alarmMuxInit(ds3231_t *rtcP)
+{
+	muxRtcP = rtcP;
+	heapSize = 0;
+	nextSeq = 0;
+	hwArmed = false;
+	dispatching = false;
+	for (uint8_t i = 0; i < ALARM_MUX_MAX_ALARMS; i++)
+		pool[i].heapPos = FREE_SLOT;
+}
+
+/**
+*	Add an alarm.
+*	@param	when: first due time
+*	@param	periodS: re-arm this many seconds after each due time, 0 for a one shot
+*	@return	id for alarmMuxCancel, ALARM_MUX_INVALID_ID if the pool is full
+*/
+alarm_id_t alarmMuxAdd(const epoch_t when, const uint32_t periodS, void (*funcP)(void *objP), void *objP)
+{
+	if (funcP == NULL || heapSize >= ALARM_MUX_MAX_ALARMS)
+		return ALARM_MUX_INVALID_ID;
+
+	uint8_t slot = 0;
+	while (pool[slot].heapPos != FREE_SLOT)
+		slot++;
+
+	pool[slot].when = when;
+	pool[slot].periodS = periodS;
+	pool[slot].seq = nextSeq++;
+	pool[slot].funcP = funcP;
+	pool[slot].objP = objP;
+	heapPush(slot);
+
+	// Only touches the hardware if the new alarm is the earliest
+	if (heap[0] == slot)
+		alarmMuxReschedule();
+	return ((alarm_id_t)pool[slot].gen << ID_GEN_SHIFT) | slot;
+}
+
+/* Cancel an alarm. Returns false if the id isn't armed (e.g. a one shot that already fired) */
+bool alarmMuxCancel(const alarm_id_t id)
+{
+	uint8_t slot = id & ID_SLOT_MASK;
+
+	if (slot >= ALARM_MUX_MAX_ALARMS || pool[slot].heapPos == FREE_SLOT || pool[slot].gen != id >> ID_GEN_SHIFT)
+		return false;
+
+	bool wasFirst = pool[slot].heapPos == 0;
+	heapRemove(pool[slot].heapPos);
+	if (wasFirst && !dispatching)
+		programHardware();
+	return true;
+}
+
+/* Due time of the earliest alarm */
+bool alarmMuxNext(epoch_t *whenP)
+{
+	if (!heapSize)
+		return false;
+
+	*whenP = pool[heap[0]].when;
+	return true;
+}
+
+/* Run whatever is overdue and reprogram Alarm 1. Call after the RTC time is changed. No-op from a callback */
+void alarmMuxReschedule(void)
+{
+	epoch_t now;
+
+	if (dispatching)
+		return;
+
+	hwArmed = false;
+	if (muxNow(&now))
+		dispatchDue(now);
+	programHardware();
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+/* Heap order: due time, then add order */
+static bool isBefore(const uint8_t a, const uint8_t b)
+{
+	int32_t diff = epochDiff(pool[a].when, pool[b].when);
+	return diff < 0 || (diff == 0 && (int16_t)(pool[a].seq - pool[b].seq) < 0);
+}
+
+static void heapSwap(const uint8_t i, const uint8_t j)
+{
+	uint8_t tmp = heap[i];
+	heap[i] = heap[j];
+	heap[j] = tmp;
+	pool[heap[i]].heapPos = i;
+	pool[heap[j]].heapPos = j;
+}
+
+static void siftUp(uint8_t pos)
+{
+	while (pos > 0)
+	{
+		uint8_t parent = (pos - 1) >> 1;
+		if (!isBefore(heap[pos], heap[parent]))
+			break;
+		heapSwap(pos, parent);
+		pos = parent;
+	}
+}
+
+static void siftDown(uint8_t pos)
+{
+	while (1)
+	{
+		uint8_t first = pos;
+		uint8_t left = (pos << 1) + 1;
+		uint8_t right = left + 1;
+
+		if (left < heapSize && isBefore(heap[left], heap[first]))
+			first = left;
+		if (right < heapSize && isBefore(heap[right], heap[first]))
+			first = right;
+		if (first == pos)
+			break;
+		heapSwap(pos, first);
+		pos = first;
+	}
+}
+
+static void heapPush(const uint8_t slot)
+{
+	heap[heapSize] = slot;
+	pool[slot].heapPos = heapSize;
+	siftUp(heapSize++);
+}
+
+/* Take the entry at pos out of the heap and free its pool slot */
+static void heapRemove(const uint8_t pos)
+{
+	uint8_t slot = heap[pos];
+	uint8_t last = heap[--heapSize];
+
+	pool[slot].heapPos = FREE_SLOT;
+	pool[slot].gen++;
+	if (pos < heapSize)
+	{
+		heap[pos] = last;
+		pool[last].heapPos = pos;
+		siftUp(pos);
+		siftDown(pool[last].heapPos);
+	}
+}
+
+/* Software clock if it has synced, otherwise the last time read from the RTC. False if neither is usable */
+static bool muxNow(epoch_t *nowP)
+{
+	if (!softClockIsValid())
+		return epochFromBcd(muxRtcP->time, nowP);
+
+	*nowP = softClockNow();
+	return true;
+}
+
+/**
+*	Pop and run every alarm due at or before now, earliest first. Recurring ones go back in the heap.
+*	The heap is consistent again before each callback runs, and anything a callback adds that is already due
+*	runs in the same pass. The caller reprograms Alarm 1 afterwards.
+*/
+static void dispatchDue(const epoch_t now)
+{
+	dispatching = true;
+	while (heapSize && epochDiff(pool[heap[0]].when, now) <= 0)
+	{
+		uint8_t slot = heap[0];
+		void (*funcP)(void *objP) = pool[slot].funcP;
+		void *objP = pool[slot].objP;
+
+		if (pool[slot].periodS)
+		{
+			// Skip periods that were missed entirely (e.g. the time was set forward)
+			do
+				pool[slot].when += pool[slot].periodS;
+			while (epochDiff(pool[slot].when, now) <= 0);
+			pool[slot].seq = nextSeq++;
+			siftDown(0);
+		}
+		else
+			heapRemove(0);
+
+		funcP(objP);
+	}
+	dispatching = false;
+}
+
+/* Put the earliest alarm in Alarm 1, or turn Alarm 1 off if there is none */
+static void programHardware(void)
+{
+	if (!heapSize)
+	{
+		if (muxRtcP->ctrlReg & AI1E_FLAG)
+			ds3231SetCtrlReg(muxRtcP, muxRtcP->ctrlReg & ~AI1E_FLAG);
+		hwArmed = false;
+		return;
+	}
+
+	epoch_t when = pool[heap[0]].when;
+	if (hwArmed && when == hwWhen)
+		return;
+
+	// Alarm 1 matches date, hour, minute and second. Takes decimal values
+	uint8_t bcd[TIME_UNITS_TOTAL];
+	epochToBcd(when, bcd);
+	uint8_t a1Time[TOTAL_ALARM1_REGISTERS] =
+	{
+		epochBcdToBin(bcd[TIME_UNITS_SEC]), epochBcdToBin(bcd[TIME_UNITS_MIN]),
+		epochBcdToBin(bcd[TIME_UNITS_HR]), epochBcdToBin(bcd[TIME_UNITS_DT])
+	};
+	hwArmed = ds3231SetAlarm1(muxRtcP, a1Time, A1_MATCH_DT_HR_MIN_SEC, hwAlarmCB, NULL);
+	hwWhen = when;
+}
+
+/**
+*	Alarm 1 callback, runs from ds3231Poll right after the registers were read. A due time more than a month out
+*	matches early on the same date/time; nothing is due then and the same time is simply programmed again.
+*/
+static void hwAlarmCB(void *objP)
+{
+	epoch_t now;
+
+	hwArmed = false;
+	if (epochFromBcd(muxRtcP->time, &now))
+		dispatchDue(now);
+	programHardware();
+}
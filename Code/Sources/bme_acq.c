@@ -0,0 +1,386 @@
+/*
+ * bme_acq.c
+ *
+ * Created: 10/19/2026 9:26:03 PM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "bme_acq.h"
+#include "bme_comp.h"
+#include "timer.h"
+#include <stddef.h>
+
+#define STATUS_MEASURING		(0x08)		// Status register bit 3: conversion running
+#define MAX_ERROR_COUNT			(0xFFFF)
+
+/* t_standby per BME280_STANDBY_TIME_x code, rounded up to whole ms */
+static const uint16_t standbyMs[8] = { 1, 63, 125, 250, 500, 1000, 10, 20 };
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+static bool conversionDone(bme_acq_t *acqP, const uint32_t now);
+static void fail(bme_acq_t *acqP, const int8_t rslt);
+static bool settingsChanged(const bme_acq_t *acqP);
+static int8_t applySettings(bme_acq_t *acqP);
+static int8_t writeCtrlMeas(bme_acq_t *acqP, const uint8_t mode);
+static struct bme280_dev *selectSensor(bme_acq_t *acqP);
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/**
+*	Set up an acquisition for the sensor at addr, right after bme280_init ran on devP for that address (soft
+*	reset, so asleep). Its calibration is copied so devP can be reused to init the next sensor. The settings
+*	are sent on the first start; the register contents are not trusted until then.
+*/
+void bmeAcqInit(bme_acq_t *acqP, struct bme280_dev *devP, const uint8_t addr,
+				const struct bme280_settings *settingsP, bme_acq_cb_t funcP, void *objP)
+{
+	acqP->devP = devP;
+	acqP->addr = addr;
+	acqP->calib = devP->calib_data;
+	acqP->appliedValid = false;
+	acqP->powerMode = BME280_SLEEP_MODE;
+	acqP->state = BME_ACQ_IDLE;
+	acqP->streaming = false;
+	bmeAcqSetSettings(acqP, settingsP);
+	acqP->lastWaitMs = 0;
+	acqP->dataValid = false;
+	acqP->lastResult = BME280_OK;
+	acqP->errorCount = 0;
+	acqP->funcP = funcP;
+	acqP->objP = objP;
+}
+
+/* Queue one measurement. Returns false if one is already in progress */
+bool bmeAcqStart(bme_acq_t *acqP)
+{
+	if (acqP->state != BME_ACQ_IDLE)
+		return false;
+
+	acqP->streaming = false;
+	acqP->state = settingsChanged(acqP) ? BME_ACQ_CONFIGURE : BME_ACQ_TRIGGER;
+	return true;
+}
+
+/**
+*	Put the sensor in normal mode and publish every output period until bmeAcqStop. The sensor converts and
+*	filters on its own, so each period costs a single 8 byte burst read. Returns false if already busy.
+*/
+bool bmeAcqStartStream(bme_acq_t *acqP)
+{
+	if (acqP->state != BME_ACQ_IDLE)
+		return false;
+
+	acqP->streaming = true;
+	acqP->state = settingsChanged(acqP) ? BME_ACQ_CONFIGURE : BME_ACQ_TRIGGER;
+	return true;
+}
+
+/* Stop streaming and put the sensor back to sleep. A forced acquisition in progress is dropped */
+bool bmeAcqStop(bme_acq_t *acqP)
+{
+	bool ok = true;
+
+	if (acqP->powerMode == BME280_NORMAL_MODE)
+		ok = writeCtrlMeas(acqP, BME280_SLEEP_MODE) == BME280_OK;
+
+	acqP->streaming = false;
+	acqP->state = BME_ACQ_IDLE;
+	return ok;
+}
+
+/**
+*	Change oversampling/filter/standby. Only the registers that differ are written, on the next start.
+*	Returns false while an acquisition or stream is running.
+*/
+bool bmeAcqSetSettings(bme_acq_t *acqP, const struct bme280_settings *settingsP)
+{
+	if (acqP->state != BME_ACQ_IDLE)
+		return false;
+
+	acqP->settings = *settingsP;
+	acqP->maxWaitMs = bme280_cal_meas_delay(settingsP) + 1;		// The driver truncates to whole ms
+	acqP->periodMs = acqP->maxWaitMs + standbyMs[settingsP->standby_time & 0x07];
+	return true;
+}
+
+/**
+*	Advance the acquisition by at most one step. Never waits: each step is a single short I2C transfer or
+*	some arithmetic, and the conversion time is spent returning straight back to the main loop.
+*/
+void bmeAcqService(bme_acq_t *acqP)
+{
+	int8_t rslt;
+	uint32_t now;
+
+	switch (acqP->state)
+	{
+		case BME_ACQ_IDLE:
+			break;
+
+		case BME_ACQ_CONFIGURE:
+			rslt = applySettings(acqP);
+			if (rslt != BME280_OK)
+			{
+				fail(acqP, rslt);
+				break;
+			}
+			acqP->state = BME_ACQ_TRIGGER;
+			break;
+
+		case BME_ACQ_TRIGGER:
+			/* ctrl_meas carries osr_t/osr_p and the mode, and also latches ctrl_hum: one write starts it all */
+			rslt = writeCtrlMeas(acqP, acqP->streaming ? BME280_NORMAL_MODE : BME280_FORCED_MODE);
+			if (rslt != BME280_OK)
+			{
+				fail(acqP, rslt);
+				break;
+			}
+			acqP->triggerMs = acqP->lastPollMs = getMillis();
+			if (acqP->streaming)
+			{
+				/* First output is ready one measurement time after the mode write */
+				acqP->lastReadMs = acqP->triggerMs - acqP->periodMs + acqP->maxWaitMs;
+				acqP->state = BME_ACQ_STREAM;
+			}
+			else
+			{
+				acqP->state = BME_ACQ_WAIT;
+			}
+			break;
+
+		case BME_ACQ_STREAM:
+			now = getMillis();
+			if (now - acqP->lastReadMs < acqP->periodMs)
+				break;
+			acqP->lastReadMs = now;
+			if (acqP->powerMode == BME280_NORMAL_MODE)
+			{
+				acqP->state = BME_ACQ_READ;
+				break;
+			}
+			/* Retrying a failed start. Its mode is unknown: sleep first so the config write isn't ignored */
+			rslt = writeCtrlMeas(acqP, BME280_SLEEP_MODE);
+			if (rslt != BME280_OK)
+			{
+				fail(acqP, rslt);
+				break;
+			}
+			acqP->state = BME_ACQ_CONFIGURE;
+			break;
+
+		case BME_ACQ_WAIT:
+			now = getMillis();
+			if (now - acqP->triggerMs >= acqP->maxWaitMs || conversionDone(acqP, now))
+			{
+				/* Forced mode drops back to sleep by itself once the conversion is done */
+				acqP->lastWaitMs = (uint8_t)(now - acqP->triggerMs);
+				acqP->powerMode = BME280_SLEEP_MODE;
+				acqP->state = BME_ACQ_READ;
+			}
+			break;
+
+		case BME_ACQ_READ:
+			rslt = bme280_get_regs(BME280_DATA_ADDR, acqP->rawData, BME280_P_T_H_DATA_LEN, selectSensor(acqP));
+			if (rslt != BME280_OK)
+			{
+				fail(acqP, rslt);
+				break;
+			}
+			acqP->state = BME_ACQ_COMPENSATE;
+			break;
+
+		case BME_ACQ_COMPENSATE:
+		{
+			struct bme280_uncomp_data uncomp;
+			bme280_parse_sensor_data(acqP->rawData, &uncomp);
+#ifdef BME280_32BIT_ENABLE
+			bmeCompensate(&uncomp, &acqP->calib, &acqP->data);
+#else
+			rslt = bme280_compensate_data(BME280_ALL, &uncomp, &acqP->data, &acqP->calib);
+			if (rslt != BME280_OK)
+			{
+				fail(acqP, rslt);
+				break;
+			}
+#endif
+			acqP->dataValid = true;
+			acqP->lastResult = BME280_OK;
+			acqP->state = BME_ACQ_PUBLISH;
+			break;
+		}
+
+		case BME_ACQ_PUBLISH:
+			acqP->state = acqP->powerMode == BME280_NORMAL_MODE ? BME_ACQ_STREAM : BME_ACQ_IDLE;
+			if (acqP->funcP != NULL)
+				acqP->funcP(acqP->objP, &acqP->data);
+			break;
+
+		default:
+			acqP->state = BME_ACQ_IDLE;
+			break;
+	}
+}
+
+/* True from bmeAcqStart until the result has been published (or dropped), or while streaming */
+bool bmeAcqIsBusy(const bme_acq_t *acqP)
+{
+	return acqP->state != BME_ACQ_IDLE;
+}
+
+/* Copy the last good measurement. Returns false if there hasn't been one yet */
+bool bmeAcqGetData(const bme_acq_t *acqP, struct bme280_data *dataP)
+{
+	if (!acqP->dataValid)
+		return false;
+
+	*dataP = acqP->data;
+	return true;
+}
+
+/**
+*	Convert a compensated result to display units with rounding. Integer builds stay in 32-bit arithmetic:
+*	temperature comes in 0.01C and humidity in 1/1024 %RH. Pressure is in Pa from bmeCompensate
+*	(BME280_32BIT_ENABLE) but in 0.01 Pa from the driver's 64-bit path.
+*/
+void bmeAcqToDisplay(const struct bme280_data *dataP, bme_display_t *dispP)
+{
+#ifdef BME280_FLOAT_ENABLE
+	dispP->tempC100 = (int16_t)(dataP->temperature * 100.0 + (dataP->temperature < 0 ? -0.5 : 0.5));
+	dispP->humidity100 = (uint16_t)(dataP->humidity * 100.0 + 0.5);
+	dispP->pressure10 = (uint16_t)(dataP->pressure / 10.0 + 0.5);
+#else
+	dispP->tempC100 = (int16_t)dataP->temperature;
+	dispP->humidity100 = (uint16_t)((dataP->humidity * 100 + 512) >> 10);
+#ifdef BME280_32BIT_ENABLE
+	dispP->pressure10 = (uint16_t)((dataP->pressure + 5) / 10);
+#else
+	dispP->pressure10 = (uint16_t)((dataP->pressure + 500) / 1000);
+#endif
+#endif
+	dispP->tempF100 = bmeAcqC100ToF100(dispP->tempC100);
+}
+
+/* C x100 to F x100 (x9/5 + 32), rounded half away from zero. Everything shown in F goes through here */
+int16_t bmeAcqC100ToF100(const int16_t tempC100)
+{
+	int32_t t9 = (int32_t)tempC100 * 9;
+	return (int16_t)((t9 < 0 ? t9 - 2 : t9 + 2) / 5 + 3200);
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+/**
+*	Poll the measuring bit every BME_ACQ_STATUS_POLL_MS, starting at the datasheet typical conversion time
+*	(about 1/8 under the bme280_cal_meas_delay maximum). Polling earlier only costs bus time, which adds up
+*	with several sensors converting at once.
+*/
+static bool conversionDone(bme_acq_t *acqP, const uint32_t now)
+{
+	if (now - acqP->triggerMs < (uint32_t)(acqP->maxWaitMs - acqP->maxWaitMs / 8))
+		return false;
+	if (now - acqP->lastPollMs < BME_ACQ_STATUS_POLL_MS)
+		return false;
+	acqP->lastPollMs = now;
+
+	uint8_t status;
+	if (bme280_get_regs(BME280_STATUS_REG_ADDR, &status, 1, selectSensor(acqP)) != BME280_OK)
+		return false;	// Let the deadline take over
+
+	return !(status & STATUS_MEASURING);
+}
+
+/**
+*	Drop the acquisition on a driver error. A sensor already free running keeps streaming and is simply read
+*	again next period. Otherwise it is unknown what reached the sensor, so the next start rewrites everything:
+*	the scheduler's next bmeAcqStart in forced mode, or the stream itself one output period from now.
+*/
+static void fail(bme_acq_t *acqP, const int8_t rslt)
+{
+	acqP->lastResult = rslt;
+	if (acqP->errorCount < MAX_ERROR_COUNT)
+		acqP->errorCount++;
+
+	if (acqP->powerMode == BME280_NORMAL_MODE)
+	{
+		acqP->state = BME_ACQ_STREAM;
+		return;
+	}
+	acqP->appliedValid = false;
+	if (acqP->streaming)
+	{
+		acqP->lastReadMs = getMillis();
+		acqP->state = BME_ACQ_STREAM;
+		return;
+	}
+	acqP->state = BME_ACQ_IDLE;
+}
+
+/* True if ctrl_hum or config need rewriting. osr_t/osr_p go out with every trigger anyway */
+static bool settingsChanged(const bme_acq_t *acqP)
+{
+	return !acqP->appliedValid || acqP->applied.osr_h != acqP->settings.osr_h ||
+		   acqP->applied.filter != acqP->settings.filter || acqP->applied.standby_time != acqP->settings.standby_time;
+}
+
+/**
+*	Write ctrl_hum and/or config, whichever differ from the cache, in one burst. The sensor is asleep here
+*	(config writes are ignored in normal mode), so there is no read back and no soft reset.
+*/
+static int8_t applySettings(bme_acq_t *acqP)
+{
+	const struct bme280_settings *setP = &acqP->settings;
+	uint8_t addr[2];
+	uint8_t data[2];
+	uint8_t len = 0;
+
+	if (!acqP->appliedValid || acqP->applied.osr_h != setP->osr_h)
+	{
+		addr[len] = BME280_CTRL_HUM_ADDR;
+		data[len++] = (setP->osr_h << BME280_CTRL_HUM_POS) & BME280_CTRL_HUM_MSK;
+	}
+	if (!acqP->appliedValid || acqP->applied.filter != setP->filter ||
+		acqP->applied.standby_time != setP->standby_time)
+	{
+		addr[len] = BME280_CONFIG_ADDR;
+		data[len++] = ((setP->standby_time << BME280_STANDBY_POS) & BME280_STANDBY_MSK) |
+					  ((setP->filter << BME280_FILTER_POS) & BME280_FILTER_MSK);
+	}
+
+	int8_t rslt = len ? bme280_set_regs(addr, data, len, selectSensor(acqP)) : BME280_OK;
+	if (rslt == BME280_OK)
+	{
+		acqP->applied = *setP;
+		acqP->appliedValid = true;
+	}
+	return rslt;
+}
+
+/* Single register write of osr_t, osr_p and the power mode */
+static int8_t writeCtrlMeas(bme_acq_t *acqP, const uint8_t mode)
+{
+	uint8_t addr = BME280_CTRL_MEAS_ADDR;
+	uint8_t data = ((acqP->settings.osr_t << BME280_CTRL_TEMP_POS) & BME280_CTRL_TEMP_MSK) |
+				   ((acqP->settings.osr_p << BME280_CTRL_PRESS_POS) & BME280_CTRL_PRESS_MSK) |
+				   (mode & BME280_SENSOR_MODE_MSK);
+
+	int8_t rslt = bme280_set_regs(&addr, &data, 1, selectSensor(acqP));
+	if (rslt == BME280_OK)
+		acqP->powerMode = mode;
+	return rslt;
+}
+
+/* Point the shared device at this sensor's address */
+static struct bme280_dev *selectSensor(bme_acq_t *acqP)
+{
+	acqP->devP->intf_ptr = &acqP->addr;
+	return acqP->devP;
+}
@@ -0,0 +1,123 @@
+/*
+ * bme_comp.c
+ *
+ * Created: 10/20/2026 2:21:45 PM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "bme_comp.h"
+
+#ifndef BME280_FLOAT_ENABLE
+
+#define TEMP_MIN_C100			(-4000)
+#define TEMP_MAX_C100			(8500)
+#define PRESSURE_MIN_PA			(30000UL)
+#define PRESSURE_MAX_PA			(110000UL)
+#define HUMIDITY_MAX			(102400UL)		// 100 %RH in 1/1024 %RH
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+static int32_t compTemperature(const uint32_t raw, struct bme280_calib_data *calibP);
+static uint32_t compPressure(const uint32_t raw, const struct bme280_calib_data *calibP);
+static uint32_t compHumidity(const uint32_t raw, const struct bme280_calib_data *calibP);
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/* All three channels of one raw reading. Updates calibP->t_fine, which pressure and humidity depend on */
+void bmeCompensate(const struct bme280_uncomp_data *uncompP, struct bme280_calib_data *calibP,
+				   struct bme280_data *dataP)
+{
+	dataP->temperature = compTemperature(uncompP->temperature, calibP);
+	dataP->pressure = compPressure(uncompP->pressure, calibP);
+	dataP->humidity = compHumidity(uncompP->humidity, calibP);
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+/* 0.01C, clamped to the sensor's operating range */
+static int32_t compTemperature(const uint32_t raw, struct bme280_calib_data *calibP)
+{
+	int32_t var1 = (int32_t)((raw / 8) - ((int32_t)calibP->dig_t1 * 2));
+	var1 = (var1 * (int32_t)calibP->dig_t2) / 2048;
+	int32_t var2 = (int32_t)((raw / 16) - (int32_t)calibP->dig_t1);
+	var2 = (((var2 * var2) / 4096) * (int32_t)calibP->dig_t3) / 16384;
+	calibP->t_fine = var1 + var2;
+
+	int32_t temperature = (calibP->t_fine * 5 + 128) / 256;
+	if (temperature < TEMP_MIN_C100)
+		return TEMP_MIN_C100;
+	if (temperature > TEMP_MAX_C100)
+		return TEMP_MAX_C100;
+	return temperature;
+}
+
+/**
+*	Pa, clamped to the sensor's operating range. The datasheet computes dig_p2 * var1 / 2 with var1 near
+*	-166000 at -40C, past int32 once |dig_p2| > ~12900 (dig_p2 is a full int16). var1 / 4 keeps it in range.
+*	The extra truncation can move the / 262144 result by one count, a few Pa at the end, within the formula's
+*	own rounding: both stay within 7 Pa of the float formula.
+*/
+static uint32_t compPressure(const uint32_t raw, const struct bme280_calib_data *calibP)
+{
+	int32_t var1 = (calibP->t_fine / 2) - 64000;
+	int32_t var2 = (((var1 / 4) * (var1 / 4)) / 2048) * (int32_t)calibP->dig_p6;
+	var2 = var2 + ((var1 * (int32_t)calibP->dig_p5) * 2);
+	var2 = (var2 / 4) + ((int32_t)calibP->dig_p4 * 65536);
+	int32_t var3 = (calibP->dig_p3 * (((var1 / 4) * (var1 / 4)) / 8192)) / 8;
+	int32_t var4 = (int32_t)calibP->dig_p2 * (var1 / 4);
+	var1 = ((var3 / 2) + var4) / 131072;
+	var1 = ((32768 + var1) * (int32_t)calibP->dig_p1) / 32768;
+
+	if (var1 == 0)
+		return PRESSURE_MIN_PA;		// Blank calibration, avoid the divide by zero
+
+	uint32_t pressure = ((uint32_t)(1048576UL - raw) - (uint32_t)(var2 / 4096)) * 3125;
+	if (pressure < 0x80000000UL)
+		pressure = (pressure << 1) / (uint32_t)var1;
+	else
+		pressure = (pressure / (uint32_t)var1) * 2;
+
+	var1 = ((int32_t)calibP->dig_p9 * (int32_t)(((pressure / 8) * (pressure / 8)) / 8192)) / 4096;
+	var2 = ((int32_t)(pressure / 4) * (int32_t)calibP->dig_p8) / 8192;
+	pressure = (uint32_t)((int32_t)pressure + ((var1 + var2 + calibP->dig_p7) / 16));
+
+	if (pressure < PRESSURE_MIN_PA)
+		return PRESSURE_MIN_PA;
+	if (pressure > PRESSURE_MAX_PA)
+		return PRESSURE_MAX_PA;
+	return pressure;
+}
+
+/* 1/1024 %RH, clamped to 0..100 %RH */
+static uint32_t compHumidity(const uint32_t raw, const struct bme280_calib_data *calibP)
+{
+	int32_t var1 = calibP->t_fine - 76800;
+	int32_t var2 = (int32_t)(raw * 16384);
+	int32_t var3 = (int32_t)calibP->dig_h4 * 1048576;
+	int32_t var4 = (int32_t)calibP->dig_h5 * var1;
+	int32_t var5 = (((var2 - var3) - var4) + 16384) / 32768;
+	var2 = (var1 * (int32_t)calibP->dig_h6) / 1024;
+	var3 = (var1 * (int32_t)calibP->dig_h3) / 2048;
+	var4 = ((var2 * (var3 + 32768)) / 1024) + 2097152;
+	var2 = ((var4 * (int32_t)calibP->dig_h2) + 8192) / 16384;
+	var3 = var5 * var2;
+	var4 = ((var3 / 32768) * (var3 / 32768)) / 128;
+	var5 = var3 - ((var4 * (int32_t)calibP->dig_h1) / 16);
+	if (var5 < 0)
+		var5 = 0;
+	if (var5 > 419430400)
+		var5 = 419430400;
+
+	uint32_t humidity = (uint32_t)var5 / 4096;
+	return humidity > HUMIDITY_MAX ? HUMIDITY_MAX : humidity;
+}
+
+#endif /* BME280_FLOAT_ENABLE */
@@ -0,0 +1,114 @@
+/*
+ * bme_profile.c
+ *
+ * Created: 10/19/2026 11:49:15 PM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "bme_profile.h"
+
+/* Datasheet typical measurement currents (uA) and phase durations (us per oversampling step) */
+#define CURRENT_T_UA			(350)
+#define CURRENT_P_UA			(714)
+#define CURRENT_H_UA			(340)
+#define STARTUP_US				(1000)
+#define PHASE_US				(2000)
+#define PH_OFFSET_US			(500)		// Extra settling before the pressure and humidity phases
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+static const struct bme280_settings profileSettings[BME_NUM_PROFILES] =
+{
+	[BME_PROFILE_WEATHER] =
+	{
+		.osr_p = BME280_OVERSAMPLING_1X, .osr_t = BME280_OVERSAMPLING_1X, .osr_h = BME280_OVERSAMPLING_1X,
+		.filter = BME280_FILTER_COEFF_OFF, .standby_time = BME280_STANDBY_TIME_1000_MS
+	},
+	[BME_PROFILE_LOW_POWER] =
+	{
+		.osr_p = BME280_NO_OVERSAMPLING, .osr_t = BME280_OVERSAMPLING_1X, .osr_h = BME280_OVERSAMPLING_1X,
+		.filter = BME280_FILTER_COEFF_OFF, .standby_time = BME280_STANDBY_TIME_1000_MS
+	},
+	[BME_PROFILE_HIGH_ACCURACY] =
+	{
+		.osr_p = BME280_OVERSAMPLING_4X, .osr_t = BME280_OVERSAMPLING_4X, .osr_h = BME280_OVERSAMPLING_4X,
+		.filter = BME280_FILTER_COEFF_4, .standby_time = BME280_STANDBY_TIME_125_MS
+	}
+};
+
+static const char *const profileNames[BME_NUM_PROFILES] =
+{
+	"Weather", "LowPower", "HiAccur"
+};
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+static uint16_t estimateCharge(const struct bme280_settings *settingsP);
+static uint8_t osrSamples(const uint8_t osr);
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/* Copy a profile's oversampling/filter/standby settings */
+bool bmeProfileGetSettings(const bme_profile_t profile, struct bme280_settings *settingsP)
+{
+	if (profile >= BME_NUM_PROFILES)
+		return false;
+
+	*settingsP = profileSettings[profile];
+	return true;
+}
+
+/* Name, worst case conversion time and estimated charge per sample of a profile */
+bool bmeProfileGetInfo(const bme_profile_t profile, bme_profile_info_t *infoP)
+{
+	if (profile >= BME_NUM_PROFILES)
+		return false;
+
+	infoP->name = profileNames[profile];
+	infoP->measMs = bme280_cal_meas_delay(&profileSettings[profile]);
+	infoP->chargeNc = estimateCharge(&profileSettings[profile]);
+	return true;
+}
+
+/* Switch an acquisition to a profile. Returns false while it is busy (retry once it is idle) */
+bool bmeProfileApply(bme_acq_t *acqP, const bme_profile_t profile)
+{
+	if (profile >= BME_NUM_PROFILES)
+		return false;
+
+	return bmeAcqSetSettings(acqP, &profileSettings[profile]);
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+/**
+*	Sum current x time over the measurement phases: start-up and temperature at the temperature current, then
+*	pressure and humidity (each with its settling offset) when not skipped. Sleep current is left out.
+*/
+static uint16_t estimateCharge(const struct bme280_settings *settingsP)
+{
+	uint32_t chargePc = (uint32_t)CURRENT_T_UA * (STARTUP_US + (uint32_t)PHASE_US * osrSamples(settingsP->osr_t));
+	uint8_t n;
+
+	if ((n = osrSamples(settingsP->osr_p)) != 0)
+		chargePc += (uint32_t)CURRENT_P_UA * (PH_OFFSET_US + (uint32_t)PHASE_US * n);
+	if ((n = osrSamples(settingsP->osr_h)) != 0)
+		chargePc += (uint32_t)CURRENT_H_UA * (PH_OFFSET_US + (uint32_t)PHASE_US * n);
+
+	return (uint16_t)((chargePc + 500) / 1000);
+}
+
+/* Oversampling register code to number of samples (0 = skipped) */
+static uint8_t osrSamples(const uint8_t osr)
+{
+	return osr == BME280_NO_OVERSAMPLING ? 0 : osr >= BME280_OVERSAMPLING_16X ? 16 : 1 << (osr - 1);
+}
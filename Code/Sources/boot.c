@@ -0,0 +1,62 @@
+/*
+ * boot.c
+ *
+ * Created: 10/19/2026 4:10:44 PM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "boot.h"
+#include "timer.h"
+#include <stddef.h>
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+static boot_step_cb_t deferredSteps[BOOT_MAX_DEFERRED];
+static uint8_t numDeferred;
+static uint8_t nextDeferred;
+static boot_times_t bootTimes;
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/* Queue a non critical step to run after the first frame. Steps run in the order they were queued */
+bool bootDefer(boot_step_cb_t stepCB)
+{
+	if (stepCB == NULL || numDeferred >= BOOT_MAX_DEFERRED)
+		return false;
+
+	deferredSteps[numDeferred++] = stepCB;
+	return true;
+}
+
+/* Mark the first frame as shown. Ticks count from startMillisTimer */
+void bootFirstFrame(void)
+{
+	bootTimes.firstFrameUs = ticksToMicroseconds(getTicks());
+}
+
+/* Run the next deferred step. Returns false once there is nothing left to run */
+bool bootRunDeferred(void)
+{
+	if (nextDeferred >= numDeferred)
+		return false;
+
+	if (!deferredSteps[nextDeferred]())
+		bootTimes.failedSteps |= (1 << nextDeferred);
+	nextDeferred++;
+
+	if (nextDeferred == numDeferred)
+		bootTimes.deferredUs = ticksToMicroseconds(getTicks());
+	return true;
+}
+
+/* Snapshot boot timings */
+void bootGetTimes(boot_times_t *timesP)
+{
+	*timesP = bootTimes;
+}
@@ -0,0 +1,125 @@
+/*
+ * climate.c
+ *
+ * Created: 10/19/2026 10:58:12 PM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "climate.h"
+#include <avr/pgmspace.h>
+
+#define TABLE_SIZE			(CLIMATE_MAX_C - CLIMATE_MIN_C + 1)
+#define MIN_C100			(CLIMATE_MIN_C * 100)
+#define MAX_C100			(CLIMATE_MAX_C * 100)
+#define KELVIN_C100			(27315)
+#define ABS_HUM_K			(21674)		// AH [g/m3] = 2.1674 * e [Pa] / T [K]
+#define MAX_SAMPLES			(0xFFFF)
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+
+/* Saturation vapour pressure over water in Pa, one entry per C: 610.94 * exp(17.625 * T / (T + 243.04)) */
+static const uint16_t svpTable[TABLE_SIZE] PROGMEM =
+{
+	  126,   137,   149,   162,   176,   192,   208,   226,   245,   265,	// -20..-11C
+	  287,   310,   335,   362,   391,   422,   455,   490,   528,   568,	// -10..-1C
+	  611,   657,   705,   757,   813,   872,   934,  1001,  1071,  1146,	// 0..9C
+	 1226,  1311,  1400,  1495,  1596,  1702,  1815,  1934,  2060,  2193,	// 10..19C
+	 2333,  2482,  2639,  2804,  2978,  3162,  3355,  3559,  3774,  3999,	// 20..29C
+	 4237,  4486,  4749,  5024,  5314,  5618,  5936,  6271,  6622,  6989,	// 30..39C
+	 7375,  7778,  8201,  8643,  9106,  9590, 10097, 10626, 11179, 11757,	// 40..49C
+	12361, 12991, 13648, 14334, 15050, 15796, 16574, 17384, 18228, 19108,	// 50..59C
+	20023,	// 60..60C
+};
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/* Forget the running average */
+void climateReset(climate_t *climateP)
+{
+	climateP->svpPa = climateP->vapourPa = climateP->vpdPa = 0;
+	climateP->dewPointC100 = 0;
+	climateP->absHumidity100 = 0;
+	climateP->vpdAvgScaled = 0;
+	climateP->samples = 0;
+}
+
+/* Derive all metrics from one sample. tempC100 is C x100, rh100 is %RH x100 */
+void climateUpdate(climate_t *climateP, const int16_t tempC100, const uint16_t rh100)
+{
+	uint16_t rh = rh100 > 10000 ? 10000 : rh100;
+
+	climateP->svpPa = climateSvp(tempC100);
+	climateP->vapourPa = (uint16_t)(((uint32_t)climateP->svpPa * rh + 5000) / 10000);
+	climateP->vpdPa = climateP->svpPa - climateP->vapourPa;
+	climateP->dewPointC100 = climateDewPoint(climateP->vapourPa);
+
+	/* Absolute temperature in C x100 keeps the divide in 32 bits */
+	uint32_t kelvin100 = (uint32_t)((int32_t)tempC100 + KELVIN_C100);
+	climateP->absHumidity100 = (uint16_t)(((uint32_t)climateP->vapourPa * ABS_HUM_K + kelvin100 / 2) / kelvin100);
+
+	/* Running average: start from the first sample, then move 1/8 of the way each time */
+	if (climateP->samples == 0)
+		climateP->vpdAvgScaled = (uint32_t)climateP->vpdPa << CLIMATE_AVG_SHIFT;
+	else
+		climateP->vpdAvgScaled += (uint32_t)climateP->vpdPa - (climateP->vpdAvgScaled >> CLIMATE_AVG_SHIFT);
+	if (climateP->samples < MAX_SAMPLES)
+		climateP->samples++;
+}
+
+/* Running VPD average in Pa */
+uint16_t climateVpdAverage(const climate_t *climateP)
+{
+	return (uint16_t)((climateP->vpdAvgScaled + (1 << (CLIMATE_AVG_SHIFT - 1))) >> CLIMATE_AVG_SHIFT);
+}
+
+/* Saturation vapour pressure in Pa at tempC100 (C x100), interpolated between table entries */
+uint16_t climateSvp(const int16_t tempC100)
+{
+	int16_t t = tempC100;
+	if (t < MIN_C100)
+		t = MIN_C100;
+	if (t >= MAX_C100)
+		return pgm_read_word(&svpTable[TABLE_SIZE - 1]);
+
+	uint16_t offset = (uint16_t)(t - MIN_C100);
+	uint8_t i = offset / 100;
+	uint8_t frac = offset % 100;
+	uint16_t lo = pgm_read_word(&svpTable[i]);
+	uint16_t hi = pgm_read_word(&svpTable[i + 1]);
+
+	return lo + (uint16_t)(((uint32_t)(hi - lo) * frac + 50) / 100);
+}
+
+/* Temperature (C x100) at which vapourPa saturates. Binary search on the table, then interpolate */
+int16_t climateDewPoint(const uint16_t vapourPa)
+{
+	if (vapourPa <= pgm_read_word(&svpTable[0]))
+		return MIN_C100;
+	if (vapourPa >= pgm_read_word(&svpTable[TABLE_SIZE - 1]))
+		return MAX_C100;
+
+	/* Find lo with svpTable[lo] < vapourPa <= svpTable[lo + 1] */
+	uint8_t lo = 0;
+	uint8_t hi = TABLE_SIZE - 1;
+	while (hi - lo > 1)
+	{
+		uint8_t mid = (lo + hi) / 2;
+		if (pgm_read_word(&svpTable[mid]) < vapourPa)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	uint16_t eLo = pgm_read_word(&svpTable[lo]);
+	uint16_t eHi = pgm_read_word(&svpTable[hi]);
+	uint16_t frac = (uint16_t)(((uint32_t)(vapourPa - eLo) * 100 + (eHi - eLo) / 2) / (eHi - eLo));
+
+	return (int16_t)(MIN_C100 + lo * 100 + frac);
+}
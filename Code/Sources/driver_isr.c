@@ -37,10 +37,13 @@
 #include <compiler.h>
 #include "timer.h"
 #include "main.h"
+#include "profiler.h"
+#include "watchdog.h"
 
 ISR(PCINT1_vect)
 {
 	/* Insert your pin change 1 interrupt handling code here */
+	ds3231IntIsr();
 }
 ISR(TIMER1_CAPT_vect)
 {
@@ -51,5 +54,12 @@ ISR(TIMER1_COMPA_vect)
 {
 	/* Insert your TIMER_0 compare channel A interrupt handling code here */
 	updateMillis();
+	/* getTicks is a millisecond behind until updateMillis ran. TCNT1 alone restarted at the compare match */
+	PROF_RECORD(PROF_ISR_TIMER, TCNT1);
 
 }
+
+ISR(WDT_vect)
+{
+	watchdogIsr();
+}
@@ -15,10 +15,18 @@
 #include "stdio.h"
 #include "port.h"
 #include "i2cMasterControl.h"
+#include "timer.h"
+#include "atomic_access.h"
+#include "soft_clock.h"
 
 
 #define INTCN_PIN		PINC	
 #define INTCN_PIN_NUM	PINC3
+#define INTCN_PCMSK		PCMSK1
+#define INTCN_PCINT		PCINT11
+#define INTCN_PCIE		PCIE1
+#define INTCN_IS_LOW()	(!(INTCN_PIN & (1 << INTCN_PIN_NUM)))
+#define MAX_ERROR_COUNT	(0xFF)
 
 /* Commands data buffer sizes*/
 enum cmd_sizes
@@ -40,9 +48,15 @@ enum cmd_sizes
 /* Command response data buffer size */
 enum resp_sizes
 {
-	READ_ALL_REGS_RESP_SIZE = 19 	
+	READ_ALL_REGS_RESP_SIZE = 19,
+	READ_TICK_REGS_RESP_SIZE = 11	// Status, aging, temp MSB/LSB then wrap around to the 7 time registers
 };
 
+/* Bytes on the bus per poll, counting SLA+R/W, register pointer and the status clear write */
+#define FULL_POLL_BUS_BYTES			(2 + 1 + READ_ALL_REGS_RESP_SIZE + 3)
+#define TICK_POLL_BUS_BYTES			(2 + 1 + READ_TICK_REGS_RESP_SIZE + 3)
+#define TICK_TIME_OFFSET			(READ_TICK_REGS_RESP_SIZE - TIME_UNITS_TOTAL)
+
 /************************************************************************/
 /*                      Private Function Declaration                    */
 /************************************************************************/
@@ -58,10 +72,28 @@ static bool verifyCtrlReg(const uint8_t *dataP, const uint8_t ctrlReg);
 
 static void ds3231Update(ds3231_t *deviceP, const uint8_t regs[]);
 
+static bool ds3231ReadTickRegisters(uint8_t respData[]);
+
+static bool ds3231ReadTime(ds3231_t *deviceP, uint8_t *statRegP);
+
+static void ds3231PollTicks(ds3231_t *deviceP);
+
+static void ds3231HandleStatus(ds3231_t *deviceP, const uint8_t statReg);
+
 static bool ds3231SetTimeRegs(ds3231_t *deviceP, const uint8_t cmdBuffSize, const uint8_t startAddr,
 						   uint8_t *time, const uint8_t numTimeUnits);
 
 static bool verifyTime(uint8_t time, time_units_t unit);
+
+static void recordLatency(ds3231_t *deviceP);
+
+static void syncSoftClock(ds3231_t *deviceP);
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+static ds3231_t *irqDeviceP = NULL;		// Device whose INT/SQW line is on the pin change interrupt
+
 /************************************************************************/
 /*                      Public Functions Implementations                */
 /************************************************************************/
@@ -93,7 +125,8 @@ void ds3231Init(ds3231_t *deviceP)
 	}
 	
 	// Initial State of the Status Registers should be 0
-	deviceP->ctrlStatReg = deviceP->agingOffsetReg = deviceP->tempReg = deviceP->errorCount = 0;
+	deviceP->ctrlStatReg = deviceP->agingOffsetReg = deviceP->tempReg = 0;
+	deviceP->tempValid = false;
 	
 	/* Initialize Alarm Objects */
 	alarmInit(&deviceP->alarm1);
@@ -101,10 +134,27 @@ void ds3231Init(ds3231_t *deviceP)
 	alarmInit(&deviceP->alarm2);
 	deviceP->alarm2.matchFlag = A2_MATCH_DT_HR_MIN; // 0 
 	
-	for (int i = 0; i < 256; i ++)
-	{
-		deviceP->errorList[i] = 0; // Initialize error count list
-	}
+	ringBufferInit(&deviceP->errorLog, deviceP->errorLogStorage, sizeof(deviceP->errorLogStorage[0]),
+				   DS3231_ERROR_LOG_SIZE);
+	ds3231ClearErrors(deviceP);
+	
+	/* Alarms are signaled on the active low INT/SQW line. Let the pin change interrupt flag them */
+	deviceP->irqPending = deviceP->irqFromEdge = false;
+	deviceP->irqTick = deviceP->lastLatencyTicks = deviceP->maxLatencyTicks = 0;
+	deviceP->verifyInterval = DS3231_DEF_VERIFY_INTERVAL;
+	deviceP->pollsSinceVerify = 0;
+	deviceP->forceVerify = true;	// First alarm checks everything
+	deviceP->bytesSaved = 0;
+	deviceP->tickMode = false;
+	deviceP->pendingTicks = 0;
+	deviceP->tickTime = deviceP->lastResync = 0;
+	deviceP->tickCB = NULL;
+	deviceP->tickObjP = NULL;
+	ENTER_CRITICAL(I);
+	irqDeviceP = deviceP;
+	INTCN_PCMSK |= (1 << INTCN_PCINT);
+	PCICR |= (1 << INTCN_PCIE);
+	EXIT_CRITICAL(I);
 }
 
 /* Set seconds of RTC */
@@ -179,22 +229,37 @@ bool ds3231SetMonCen(ds3231_t *deviceP, const uint8_t month, const bool century)
 	return false;
 }
 
-/* Set all time units of RTC object */ 
+/**
+*	Set all time units of RTC object. time[] holds decimal values in time_units_t order and is left in BCD.
+*	The day of week is worked out from the date, whatever time[TIME_UNITS_DY] holds. Nothing is written to the
+*	DS3231 unless the whole time is a valid 2000-2099 date and 24 hour time.
+*/
 bool ds3231SetTime(ds3231_t *deviceP, uint8_t *time)
 {
-	if (ds3231SetTimeRegs(deviceP, SET_RTC_TIME_CMD_SIZE, RTC_SEC_ADDR, time, TIME_UNITS_TOTAL))
+	uint8_t bcd[TIME_UNITS_TOTAL];
+	epoch_t now;
+	
+	// Range check the decimal values before they become BCD, then let epochFromBcd check the date as a whole
+	for (uint8_t i = RTC_SEC_ADDR; i < TIME_UNITS_TOTAL; i++)
 	{
-		// If successful update time data member
-		for (uint8_t i = RTC_SEC_ADDR; i < TIME_UNITS_TOTAL; i++) //startAddr will match enum value of register
-		{	
-			if(verifyTime(time[i], i))
-				deviceP->time[i] = time[i];
-			else
-				return false;
-		}
-		return true;
+		if (i != TIME_UNITS_DY && !verifyTime(time[i], i))
+			return false;
+		bcd[i] = epochBinToBcd(time[i]);
 	}
-	return false;
+	if (!epochFromBcd(bcd, &now))
+		return false;
+	time[TIME_UNITS_DY] = epochDayOfWeek(now);
+	
+	if (!ds3231SetTimeRegs(deviceP, SET_RTC_TIME_CMD_SIZE, RTC_SEC_ADDR, time, TIME_UNITS_TOTAL))
+		return false;
+	
+	// ds3231SetTimeRegs converted time[] to the register values
+	for (uint8_t i = RTC_SEC_ADDR; i < TIME_UNITS_TOTAL; i++) //startAddr will match enum value of register
+		deviceP->time[i] = time[i];
+	softClockSync(now, getMillis(), false);
+	if (deviceP->tickMode)
+		deviceP->tickTime = deviceP->lastResync = now;
+	return true;
 }
 
 /* Initiate the command to set the RTC control register */
@@ -238,6 +303,10 @@ bool ds3231SetAlarm1(ds3231_t *deviceP, uint8_t *time, const enum alarm_match_op
 {
 	uint32_t matchBits = 0;
 	
+	// Alarms need the INT function of the INT/SQW pin. Leaving tick mode is up to the caller
+	if (deviceP->tickMode)
+		return false;
+	
 	uint8_t cmdBuffer[SET_ALARM1_TIME_CMD_SIZE];
 	cmdBuffer[0] = A1_SEC_ADDR; // Store addres of alarm 1 register
 	
@@ -270,6 +339,10 @@ bool ds3231SetAlarm2(ds3231_t *deviceP, uint8_t *time, const enum alarm_match_op
 {
 	uint32_t matchBits = 0;
 	
+	// Alarms need the INT function of the INT/SQW pin. Leaving tick mode is up to the caller
+	if (deviceP->tickMode)
+		return false;
+	
 	uint8_t cmdBuffer[SET_ALARM2_TIME_CMD_SIZE];
 	cmdBuffer[0] = A2_MIN_ADDR;	// Store address of alarm 2 register
 	
@@ -324,23 +397,178 @@ bool ds3231ReadRegisters(ds3231_t *deviceP, uint8_t respData[])
 	return status;
 }
 
- /* Polling routine to update an RTC object */
+ /* Set how many polls go by between full register checks. 1 reads and checks everything on every alarm */
+void ds3231SetVerifyInterval(ds3231_t *deviceP, const uint8_t polls)
+{
+	deviceP->verifyInterval = polls ? polls : 1;
+}
+
+/**
+*	Polling routine to update an RTC object. Does nothing until the INT/SQW interrupt flagged an alarm.
+*	Most alarms only read the time and status registers; the full read with the control/alarm consistency check
+*	runs every verifyInterval polls and after any I2C error.
+*/
  void ds3231Poll(ds3231_t *deviceP)
  {
-	 if (!(INTCN_PIN & (1<<INTCN_PIN_NUM)) && (deviceP->ctrlReg & AI1E_FLAG || deviceP->ctrlReg & AI2E_FLAG))
+	 if (deviceP->tickMode)
 	 {
-		  uint8_t registers[READ_ALL_REGS_RESP_SIZE];
-		  // Read registers
-		  ds3231ReadRegisters(deviceP, registers);
-	  
-		  // Update the RTC object and check for control/alarm registers mismatch
-		  ds3231Update(deviceP, registers);
+		 ds3231PollTicks(deviceP);
+		 return;
+	 }
+	 
+	 if (!atomicTestAndClear(&deviceP->irqPending))
+		return;
+		
+	 if (deviceP->ctrlReg & AI1E_FLAG || deviceP->ctrlReg & AI2E_FLAG)
+	 {
+		  bool full = deviceP->forceVerify || ++deviceP->pollsSinceVerify >= deviceP->verifyInterval;
+		  bool status;
+		  
+		  if (full)
+		  {
+			  uint8_t registers[READ_ALL_REGS_RESP_SIZE];
+			  // Read registers
+			  status = ds3231ReadRegisters(deviceP, registers);
+		  
+			  // Update the RTC object and check for control/alarm registers mismatch
+			  if (status)
+			  {
+				  ds3231Update(deviceP, registers);
+				  deviceP->pollsSinceVerify = 0;
+			  }
+		  }
+		  else
+		  {
+			  uint8_t statReg;
+			  status = ds3231ReadTime(deviceP, &statReg);
+			  if (status)
+			  {
+				  ds3231HandleStatus(deviceP, statReg);
+				  deviceP->bytesSaved += FULL_POLL_BUS_BYTES - TICK_POLL_BUS_BYTES;
+			  }
+		  }
 	  
 		  // Clear CMD complete flag and clear flags
-		  ds3231SetStatReg(deviceP,0);
+		  if (status)
+			status = ds3231SetStatReg(deviceP,0);
+			
+		  // Don't trust the cached view after a failed transfer
+		  deviceP->forceVerify = !status;
+		  if (!status)
+			ds3231AddError(deviceP, I2C_TRANSFER_FAIL);
+	 }
+	 
+	 // Line still low (e.g. other alarm latched meanwhile or the clear failed): no new edge will come, so retry
+	 ENTER_CRITICAL(P);
+	 if (INTCN_IS_LOW())
+	 {
+		 deviceP->irqTick = getTicks();
+		 deviceP->irqFromEdge = false;
+		 deviceP->irqPending = true;
 	 }
+	 EXIT_CRITICAL(P);
  }
 
+/**
+*	Switch the INT/SQW pin between the alarm interrupt and a 1Hz square wave. In tick mode every falling edge is
+*	one second: ds3231Poll advances the time and runs funcP without any I2C traffic, re-reading the registers only
+*	every DS3231_TICK_RESYNC_S. Alarms can't reach the pin in tick mode, so entering it disables them and setting
+*	an alarm fails until tick mode is left again.
+*/
+bool ds3231SetTickMode(ds3231_t *deviceP, const bool enable, void (*funcP)(void *objP), void *objP)
+{
+	if (!enable)
+	{
+		deviceP->tickMode = false;
+		return ds3231SetCtrlReg(deviceP, deviceP->ctrlReg | INTCN_FLAG);
+	}
+	
+	// Latch the time the ticks count from
+	uint8_t statReg;
+	epoch_t now;
+	if (!ds3231ReadTime(deviceP, &statReg))
+		return false;
+	if (!epochFromBcd(deviceP->time, &now))
+	{
+		ds3231AddError(deviceP, INVALID_TIME);
+		return false;
+	}
+	
+	// INTCN = 0 and RS2:RS1 = 00 is the 1Hz square wave
+	if (!ds3231SetCtrlReg(deviceP, deviceP->ctrlReg & ~(INTCN_FLAG | RS2_FLAG | RS1_FLAG | AI1E_FLAG | AI2E_FLAG)))
+		return false;
+	
+	ENTER_CRITICAL(T);
+	deviceP->tickTime = deviceP->lastResync = now;
+	deviceP->tickCB = funcP;
+	deviceP->tickObjP = objP;
+	deviceP->pendingTicks = 0;
+	deviceP->irqPending = false;
+	deviceP->tickMode = true;
+	EXIT_CRITICAL(T);
+	return true;
+}
+
+/* Number of times an error kind was seen since the last clear (saturates at 255) */
+uint8_t ds3231GetErrorCount(const ds3231_t *deviceP, const enum ds3231_errors_e error)
+{
+	return error < DS3231_NUM_ERRORS ? deviceP->errorCounts[error] : 0;
+}
+
+/* Oldest error event still in the log. Returns false once the log is empty */
+bool ds3231PopErrorEvent(ds3231_t *deviceP, ds3231_error_event_t *eventP)
+{
+	return ringBufferPop(&deviceP->errorLog, eventP);
+}
+
+/* Reset the counters and empty the log */
+void ds3231ClearErrors(ds3231_t *deviceP)
+{
+	for (uint8_t i = 0; i < DS3231_NUM_ERRORS; i++)
+		deviceP->errorCounts[i] = 0;
+	ringBufferFlush(&deviceP->errorLog);
+}
+
+/**
+*	On-die temperature from the last register read, in 0.25 degC steps (e.g. 101 == 25.25 degC). The registers
+*	come along with every alarm poll, so this costs no extra bus traffic. The DS3231 converts every 64s by itself.
+*	Returns false until the temperature has been read once.
+*/
+bool ds3231GetTemperature(const ds3231_t *deviceP, int16_t *quarterCP)
+{
+	if (!deviceP->tempValid)
+		return false;
+	
+	// 10-bit two's complement, left aligned: MSB is whole degrees, LSB bits 7:6 the quarters
+	*quarterCP = (int16_t)deviceP->tempReg >> 6;
+	return true;
+}
+
+/* Kick off a temperature conversion now instead of waiting for the 64s one. The result shows on the next read */
+bool ds3231StartTempConversion(ds3231_t *deviceP)
+{
+	// A conversion already running would ignore CONV
+	if (deviceP->ctrlStatReg & BSY_FLAG)
+		return false;
+	
+	// CONV self clears, so it is written but not kept in the cached ctrlReg
+	uint8_t cmdBuffer[SET_CONTROL_REG_CMD_SIZE] = { RTC_CTRL_ADDR, deviceP->ctrlReg | CONV_FLAG };
+	return i2cMasterTransmit(DS3231_SLAVE_ADDR, cmdBuffer, SET_CONTROL_REG_CMD_SIZE);
+}
+
+/* Called from PCINT1_vect. Pin change fires on both edges, only the falling one means an alarm or a tick */
+void ds3231IntIsr(void)
+{
+	if (irqDeviceP == NULL || !INTCN_IS_LOW())
+		return;
+	
+	if (irqDeviceP->tickMode && irqDeviceP->pendingTicks < UINT8_MAX)
+		irqDeviceP->pendingTicks++;
+	irqDeviceP->irqTick = getTicks();
+	irqDeviceP->irqFromEdge = true;
+	irqDeviceP->irqPending = true;
+}
+
 
 
 /************************************************************************/
@@ -362,7 +590,17 @@ static void configTime(uint8_t *time, const uint8_t totTimeUnits)
 /* Add error to the error tracker in RTC object */
 static void ds3231AddError(ds3231_t *deviceP, const enum ds3231_errors_e error)
 {	
-	deviceP->errorList[deviceP->errorCount++] = error; 	
+	if (deviceP->errorCounts[error] < MAX_ERROR_COUNT)
+		deviceP->errorCounts[error]++;
+	
+	// Keep the newest events: make room by dropping the oldest
+	ds3231_error_event_t event;
+	if (ringBufferIsFull(&deviceP->errorLog))
+		ringBufferPop(&deviceP->errorLog, &event);
+	
+	event.timeMs = getMillis();
+	event.error = error;
+	ringBufferPush(&deviceP->errorLog, &event);
 }
 
 /* Configure the matching condition bits in the outgoing payload */ // change comment a bit idk
@@ -439,6 +677,79 @@ static bool verifyCtrlReg(const uint8_t *dataP, const uint8_t ctrlReg)
 	return true;
 }
 
+/* Read the registers needed on every alarm in one burst: the pointer wraps from 0x12 back to 0x00 */
+static bool ds3231ReadTickRegisters(uint8_t respData[])
+{
+	uint8_t regAddr = RTC_CTRL_STAT_ADDR;
+	
+	if (!i2cMasterTransmit(DS3231_SLAVE_ADDR, &regAddr, READ_ALL_REGS_CMD_SIZE))
+		return false;
+	return i2cMasterRead(DS3231_SLAVE_ADDR, respData, READ_TICK_REGS_RESP_SIZE);
+}
+
+/* Selective read: time registers plus status, aging and temperature in one burst */
+static bool ds3231ReadTime(ds3231_t *deviceP, uint8_t *statRegP)
+{
+	uint8_t registers[READ_TICK_REGS_RESP_SIZE];
+	
+	if (!ds3231ReadTickRegisters(registers))
+		return false;
+	
+	for (uint8_t i = 0; i < TIME_UNITS_TOTAL; i++)
+		deviceP->time[i] = registers[TICK_TIME_OFFSET + i];
+	deviceP->agingOffsetReg = registers[RTC_AO_ADDR - RTC_CTRL_STAT_ADDR];
+	deviceP->tempReg = (registers[RTC_MSB_TEMP_ADDR - RTC_CTRL_STAT_ADDR] << 8) |
+					   registers[RTC_LSB_TEMP_ADDR - RTC_CTRL_STAT_ADDR];
+	deviceP->tempValid = true;
+	*statRegP = registers[0];
+	return true;
+}
+
+/* Tick mode poll: count the seconds in software, only going to the bus for the periodic resync */
+static void ds3231PollTicks(ds3231_t *deviceP)
+{
+	uint8_t ticks = atomicFetchAndClear8(&deviceP->pendingTicks);
+	if (!ticks)
+		return;
+	
+	uint32_t edgeAgeMs = ticksToMicroseconds(getTicks() - atomicRead32(&deviceP->irqTick)) / 1000;
+	bool exact = ticks == 1;
+	uint8_t statReg;
+	epoch_t readTime;
+	
+	// Seconds that piled up while the loop was busy: each one goes out with its own time, so none is skipped
+	while (--ticks)
+	{
+		deviceP->tickTime++;
+		epochToBcd(deviceP->tickTime, deviceP->time);
+		if (deviceP->tickCB != NULL)
+			deviceP->tickCB(deviceP->tickObjP);
+	}
+	
+	deviceP->tickTime++;
+	if (deviceP->tickTime - deviceP->lastResync >= DS3231_TICK_RESYNC_S && ds3231ReadTime(deviceP, &statReg))
+	{
+		// The seconds register updates on the falling edge, so this read already has the new second
+		if (epochFromBcd(deviceP->time, &readTime))
+			deviceP->tickTime = deviceP->lastResync = readTime;
+		else
+		{
+			ds3231AddError(deviceP, INVALID_TIME);
+			epochToBcd(deviceP->tickTime, deviceP->time);
+		}
+		deviceP->ctrlStatReg = statReg;
+		if (statReg & OSC_FLAG)
+			ds3231AddError(deviceP, OSC_STOP);
+	}
+	else
+		epochToBcd(deviceP->tickTime, deviceP->time);
+	
+	softClockSync(deviceP->tickTime, getMillis() - edgeAgeMs, exact);
+	
+	if (deviceP->tickCB != NULL)
+		deviceP->tickCB(deviceP->tickObjP);
+}
+
 /* Update RTC object with data read from the DS3231 and check for erros */
 static void ds3231Update(ds3231_t *deviceP, const uint8_t regs[])
 {
@@ -464,13 +775,26 @@ static void ds3231Update(ds3231_t *deviceP, const uint8_t regs[])
 		ds3231AddError(deviceP, INCONSISTENT_A2);
 	}
 	
-	/* Check Status register and clear respective bits */
-	deviceP->ctrlStatReg = regs[RTC_CTRL_STAT_ADDR];
+	deviceP->agingOffsetReg = regs[RTC_AO_ADDR];
+	deviceP->tempReg = (regs[RTC_MSB_TEMP_ADDR] << 8) | regs[RTC_LSB_TEMP_ADDR];
+	deviceP->tempValid = true;
+	
+	ds3231HandleStatus(deviceP, regs[RTC_CTRL_STAT_ADDR]);
+}
+
+/* Check Status register and run the callbacks of the alarms that fired */
+static void ds3231HandleStatus(ds3231_t *deviceP, const uint8_t statReg)
+{
+	deviceP->ctrlStatReg = statReg;
+	syncSoftClock(deviceP);
+	
 	if (deviceP->ctrlStatReg & OSC_FLAG)
 	{
 		/* Report error: OSC should normally be 0. */
 		ds3231AddError(deviceP, OSC_STOP);
 	}
+	if ((deviceP->ctrlStatReg & (A1I_FLAG | A2I_FLAG)) && (deviceP->ctrlReg & (AI1E_FLAG | AI2E_FLAG)))
+		recordLatency(deviceP);
 	if ((deviceP->ctrlStatReg & A1I_FLAG) && (deviceP->ctrlReg & AI1E_FLAG))
 	{
 		/* Execute A1 callback */
@@ -499,6 +823,31 @@ static bool ds3231SetTimeRegs(ds3231_t *deviceP, const uint8_t cmdBuffSize, cons
 	return i2cMasterTransmit(DS3231_SLAVE_ADDR, cmdBuffer, cmdBuffSize);
 }
 
+/* Time from the INT/SQW edge to the alarm callbacks about to run */
+static void recordLatency(ds3231_t *deviceP)
+{
+	uint32_t latency = getTicks() - atomicRead32(&deviceP->irqTick);
+	
+	deviceP->lastLatencyTicks = latency;
+	if (latency > deviceP->maxLatencyTicks)
+		deviceP->maxLatencyTicks = latency;
+}
+
+/* Hand the time just read to the software clock. After an alarm edge the RTC second started at the edge */
+static void syncSoftClock(ds3231_t *deviceP)
+{
+	bool exact = deviceP->irqFromEdge && (deviceP->ctrlStatReg & (A1I_FLAG | A2I_FLAG));
+	uint32_t edgeAgeMs = exact ? ticksToMicroseconds(getTicks() - atomicRead32(&deviceP->irqTick)) / 1000 : 0;
+	epoch_t now;
+	
+	if (!epochFromBcd(deviceP->time, &now))
+	{
+		ds3231AddError(deviceP, INVALID_TIME);
+		return;
+	}
+	softClockSync(now, getMillis() - edgeAgeMs, exact);
+}
+
 static bool verifyTime(uint8_t time, time_units_t unit)
 {
 	if (time < 0)
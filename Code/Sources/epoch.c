@@ -0,0 +1,144 @@
+/*
+ * epoch.c
+ *
+ * Created: 10/19/2026 5:20:03 PM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "epoch.h"
+
+#define DAYS_PER_4_YEARS		(1461)
+#define EPOCH_DAY0_DOW			(SAT)		// 2000-01-01
+#define HOUR_MASK_24H			(0x3F)
+#define MONTH_MASK				(0x1F)		// Drop century bit
+#define MAX_BCD_YEAR			(99)
+#define MAX_HOUR				(23)
+#define MAX_MIN_SEC				(59)
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+/* Days before the first of each month, non leap year */
+static const uint16_t cumDays[12] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+
+/* Days before each year of a 4 year cycle. Year 0 of the cycle is the leap year */
+static const uint16_t cycleDays[4] = { 0, 366, 731, 1096 };
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/* Packed BCD to binary: tens * 10 done as shifts */
+uint8_t epochBcdToBin(const uint8_t bcd)
+{
+	uint8_t tens = bcd >> 4;
+	return (tens << 3) + (tens << 1) + (bcd & 0x0F);
+}
+
+/* Binary (0-99) to packed BCD. (v * 205) >> 11 == v / 10 for every v < 100 */
+uint8_t epochBinToBcd(const uint8_t bin)
+{
+	uint8_t tens = (uint8_t)(((uint16_t)bin * 205) >> 11);
+	return (tens << 4) | (uint8_t)(bin - (tens << 3) - (tens << 1));
+}
+
+/* Every 4th year from 2000 to 2099 is a leap year */
+bool epochIsLeapYear(const uint8_t year)
+{
+	return (year & 0x03) == 0;
+}
+
+/**
+*	DS3231 BCD registers (time_units_t layout) to seconds since 2000.
+*	Returns false, leaving *tP alone, if a field is out of range or not valid BCD. Day of week is not checked.
+*/
+bool epochFromBcd(const uint8_t time[TIME_UNITS_TOTAL], epoch_t *tP)
+{
+	for (uint8_t i = 0; i < TIME_UNITS_TOTAL; i++)
+	{
+		if ((time[i] & 0x0F) > 9)
+			return false;
+	}
+
+	uint8_t year = epochBcdToBin(time[TIME_UNITS_YR]);
+	uint8_t month = epochBcdToBin(time[TIME_UNITS_MO_CEN] & MONTH_MASK);
+	uint8_t date = epochBcdToBin(time[TIME_UNITS_DT]);
+	uint8_t hour = epochBcdToBin(time[TIME_UNITS_HR] & HOUR_MASK_24H);
+	uint8_t min = epochBcdToBin(time[TIME_UNITS_MIN]);
+	uint8_t sec = epochBcdToBin(time[TIME_UNITS_SEC]);
+
+	if (year > MAX_BCD_YEAR || month < JAN || month > DEC || date == 0 || hour > MAX_HOUR || min > MAX_MIN_SEC ||
+		sec > MAX_MIN_SEC)
+		return false;
+
+	// Month length from the cumulative table, December runs to day 365
+	uint16_t monthEnd = month < DEC ? cumDays[month] : 365;
+	if (month == FEB && epochIsLeapYear(year))
+		monthEnd++;
+	if (date > monthEnd - cumDays[month - 1])
+		return false;
+
+	// Leap days in the years before this one: 2000, 2004, ... -> (year + 3) / 4
+	uint16_t days = (uint16_t)year * 365 + ((year + 3) >> 2) + cumDays[month - 1] + date - 1;
+	if (month > FEB && epochIsLeapYear(year))
+		days++;
+
+	uint32_t t = (uint32_t)days * 24 + hour;
+	t = t * 60 + min;
+	*tP = t * 60 + sec;
+	return true;
+}
+
+/* Seconds since 2000 to DS3231 BCD registers (time_units_t layout). Century bit is left clear */
+void epochToBcd(const epoch_t t, uint8_t time[TIME_UNITS_TOTAL])
+{
+	uint16_t days = t / EPOCH_SECS_PER_DAY;
+	uint32_t secOfDay = t - (uint32_t)days * EPOCH_SECS_PER_DAY;
+	uint16_t minOfDay = secOfDay / 60;
+	uint8_t hour = minOfDay / 60;
+
+	time[TIME_UNITS_SEC] = epochBinToBcd(secOfDay - (uint32_t)minOfDay * 60);
+	time[TIME_UNITS_MIN] = epochBinToBcd(minOfDay - (uint16_t)hour * 60);
+	time[TIME_UNITS_HR] = epochBinToBcd(hour);
+	time[TIME_UNITS_DY] = epochDayOfWeek(t);
+
+	// Year: whole 4 year cycles, then walk the (at most 3) year boundaries inside the cycle
+	uint8_t cycle = days / DAYS_PER_4_YEARS;
+	uint16_t dayOfCycle = days - (uint16_t)cycle * DAYS_PER_4_YEARS;
+	uint8_t yearOfCycle = 3;
+	while (dayOfCycle < cycleDays[yearOfCycle])
+		yearOfCycle--;
+	uint8_t year = (cycle << 2) + yearOfCycle;
+	uint16_t dayOfYear = dayOfCycle - cycleDays[yearOfCycle];
+
+	// Month: walk the cumulative table back from December. Fold Feb 29 onto the non leap table
+	bool leap = epochIsLeapYear(year);
+	uint8_t month = DEC;
+	if (leap && dayOfYear >= cumDays[MAR - 1])
+	{
+		if (dayOfYear == cumDays[MAR - 1])
+		{
+			time[TIME_UNITS_DT] = epochBinToBcd(29);
+			time[TIME_UNITS_MO_CEN] = epochBinToBcd(FEB);
+			time[TIME_UNITS_YR] = epochBinToBcd(year);
+			return;
+		}
+		dayOfYear--;
+	}
+	while (dayOfYear < cumDays[month - 1])
+		month--;
+
+	time[TIME_UNITS_DT] = epochBinToBcd(dayOfYear - cumDays[month - 1] + 1);
+	time[TIME_UNITS_MO_CEN] = epochBinToBcd(month);
+	time[TIME_UNITS_YR] = epochBinToBcd(year);
+}
+
+/* Day of week, MON == 1 ... SUN == 7 */
+DAYS epochDayOfWeek(const epoch_t t)
+{
+	uint16_t days = t / EPOCH_SECS_PER_DAY;
+	return (DAYS)((days + EPOCH_DAY0_DOW - 1) % 7 + 1);
+}
@@ -0,0 +1,109 @@
+/*
+ * filter.c
+ *
+ * Created: 10/20/2026 3:15:28 AM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "filter.h"
+
+#define MAX_REJECT_COUNT		(0xFFFF)
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+static void medianInsert(filter_t *filterP, const int16_t value);
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/* Empty the filter. emaShift 0 passes the median straight through */
+void filterInit(filter_t *filterP, const uint8_t emaShift, const uint16_t rejectBand)
+{
+	filterP->count = filterP->next = 0;
+	filterP->emaShift = emaShift;
+	filterP->rejectRun = 0;
+	filterP->rejectBand = rejectBand;
+	filterP->rejected = 0;
+	filterP->emaScaled = 0;
+}
+
+/* Feed a new reading and return the updated estimate */
+int16_t filterUpdate(filter_t *filterP, const int16_t value)
+{
+	if (filterP->count != 0 && filterP->rejectBand != 0)
+	{
+		int32_t diff = (int32_t)value - filterGet(filterP);
+		if (diff > filterP->rejectBand || diff < -(int32_t)filterP->rejectBand)
+		{
+			if (filterP->rejectRun < FILTER_REJECT_LIMIT)
+			{
+				filterP->rejectRun++;
+				if (filterP->rejected < MAX_REJECT_COUNT)
+					filterP->rejected++;
+				return filterGet(filterP);
+			}
+
+			/* Too many in a row to be spikes: start over at the new level */
+			filterP->count = filterP->next = 0;
+		}
+	}
+	filterP->rejectRun = 0;
+
+	bool first = filterP->count == 0;
+	medianInsert(filterP, value);
+	int16_t median = filterP->sorted[filterP->count / 2];
+
+	if (first)
+		filterP->emaScaled = (int32_t)median << filterP->emaShift;
+	else
+		filterP->emaScaled += median - (filterP->emaScaled >> filterP->emaShift);
+
+	return filterGet(filterP);
+}
+
+/* Current estimate, rounded to the channel units */
+int16_t filterGet(const filter_t *filterP)
+{
+	if (filterP->emaShift == 0)
+		return (int16_t)filterP->emaScaled;
+	return (int16_t)((filterP->emaScaled + (1 << (filterP->emaShift - 1))) >> filterP->emaShift);
+}
+
+/* True once at least one reading went through */
+bool filterIsValid(const filter_t *filterP)
+{
+	return filterP->count != 0;
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+/* Replace the oldest reading in the sorted window with a new one: one pass to close its gap, one to open a new one */
+static void medianInsert(filter_t *filterP, const int16_t value)
+{
+	uint8_t i;
+
+	if (filterP->count == FILTER_MEDIAN_SIZE)
+	{
+		int16_t oldest = filterP->window[filterP->next];
+		for (i = 0; filterP->sorted[i] != oldest; i++)
+			;
+		for (; i < FILTER_MEDIAN_SIZE - 1; i++)
+			filterP->sorted[i] = filterP->sorted[i + 1];
+		filterP->count--;
+	}
+
+	filterP->window[filterP->next] = value;
+	filterP->next = filterP->next < FILTER_MEDIAN_SIZE - 1 ? filterP->next + 1 : 0;
+
+	for (i = filterP->count; i > 0 && filterP->sorted[i - 1] > value; i--)
+		filterP->sorted[i] = filterP->sorted[i - 1];
+	filterP->sorted[i] = value;
+	filterP->count++;
+}
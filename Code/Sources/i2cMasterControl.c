@@ -9,10 +9,12 @@
 /*							Includes/Constants	 	                    */
 /************************************************************************/
 #include "i2cMasterControl.h"
+#include "ring_buffer.h"
+#include "profiler.h"
 #include <driver_init.h>
 #include <stdbool.h>
 
-#define MAX_ERRORS		(0x100)
+#define MAX_ERRORS		(0x10)	// Power of two. Oldest unread errors are kept, newer ones dropped
 
 /************************************************************************/
 /*							Enums Definition		 	                */
@@ -28,10 +30,11 @@ enum
 /************************************************************************/
 /*                      Private Variables                               */
 /************************************************************************/
-static uint8_t errorList[MAX_ERRORS];
-static uint8_t errorListCount;
-static bool busy;
-static bool error;
+static uint8_t errorStorage[MAX_ERRORS];
+static ring_buffer_t errorList;	// Produced by the TWI ISR callbacks, consumed by i2cMasterPopError
+static volatile bool busy;
+static volatile bool error;
+static uint8_t lastAddr;
 
 /************************************************************************/
 /*                      Private Function Declaration                    */
@@ -44,6 +47,7 @@ static i2c_operations_t i2cWriteCollisionErrCB(void *p);
 static i2c_operations_t i2cAdrrNackCB(void *p);
 static i2c_operations_t i2cTimeoutErrCB(void *p);
 static i2c_operations_t i2cDataNackCB(void *p);
+static void i2cLogError(uint8_t err);
 
 /************************************************************************/
 /*                      Public Functions Implementations                */
@@ -51,6 +55,7 @@ static i2c_operations_t i2cDataNackCB(void *p);
 /* Initialize I2C; Set up address; Assign callback functions */
 void i2cMasterInit(const uint8_t slaveAddress)
 {
+	ringBufferInit(&errorList, errorStorage, sizeof(errorStorage[0]), MAX_ERRORS);
 	I2C_0_open(slaveAddress);
 	I2C_0_set_data_complete_callback(i2cMasterReturnStopCb,NULL);
 	I2C_0_set_write_collision_callback(i2cWriteCollisionErrCB,NULL);	
@@ -62,6 +67,7 @@ void i2cMasterInit(const uint8_t slaveAddress)
 
 void i2cMasterChangeAddr(const uint8_t newAddr)
 {
+	lastAddr = newAddr;
 	I2C_0_set_address(newAddr);
 }
 
@@ -79,8 +85,10 @@ bool i2cMasterTransmit(const uint8_t newAddr, uint8_t *payload, const uint8_t da
 	I2C_0_set_buffer(payload, dataSize);
 	
 	/* Start I2C write */
+	PROF_ENTER(PROF_I2C);
 	if(I2C_0_master_operation(false) != I2C_BUSY)
 		while (busy){} // wait till we're done reading
+	PROF_EXIT(PROF_I2C);
 	return !error;
 }
 
@@ -98,8 +106,10 @@ bool i2cMasterRead(const uint8_t newAddr, uint8_t *buffP, const uint8_t size)
 	I2C_0_set_buffer(buffP, size);
 	
 	/* Start I2C read */
+	PROF_ENTER(PROF_I2C);
 	if(I2C_0_master_operation(true) != I2C_BUSY)
 		while (busy){} // wait till we're done reading
+	PROF_EXIT(PROF_I2C);
 	return !error;
 }
 
@@ -120,6 +130,20 @@ bool returnBusy()
 	return busy;
 }
 
+/* Retrieve the driver FSM state and the slave address of the last transfer, for fault reports */
+uint8_t i2cMasterGetState(uint8_t *addrP)
+{
+	if (addrP != NULL)
+		*addrP = lastAddr;
+	return I2C_0_get_state();
+}
+
+/* Retrieve the oldest logged I2C error. Returns false if there is none */
+bool i2cMasterPopError(uint8_t *errP)
+{
+	return ringBufferPop(&errorList, errP);
+}
+
 /************************************************************************/
 /*                     Private Functions Implementation                 */
 /************************************************************************/
@@ -146,21 +170,21 @@ static i2c_operations_t i2cMasterRestartReadCb(void *p)
 }
 static i2c_operations_t i2cWriteCollisionErrCB(void *p)
 {
-	errorList[errorListCount++] = writeCollision;
+	i2cLogError(writeCollision);
 	busy = false;
 	error = true;
 	return i2c_stop;
 }
 static i2c_operations_t i2cAdrrNackCB(void *p)
 {
-	errorList[errorListCount++] = addressNACK;
+	i2cLogError(addressNACK);
 	busy = false;
 	error = true;
 	return i2c_stop;
 }
 static i2c_operations_t i2cTimeoutErrCB(void *p)
 {
-	errorList[errorListCount++] = timeOut;
+	i2cLogError(timeOut);
 	busy = false;
 	error = true;
 	return i2c_reset_link;
@@ -168,8 +192,14 @@ static i2c_operations_t i2cTimeoutErrCB(void *p)
 
 static i2c_operations_t i2cDataNackCB(void *p)
 {
-	errorList[errorListCount++] = dataNACK;
+	i2cLogError(dataNACK);
 	busy = false;
 	error = true;
 	return i2c_stop;
 }
+
+/* Called from ISR context: queue error for the main loop */
+static void i2cLogError(uint8_t err)
+{
+	ringBufferPush(&errorList, &err);
+}
@@ -1,9 +1,22 @@
 #include "main.h"
 
-/* Instantiate LCD, RTC, and BME sensor */
+/* Instantiate LCD, RTC, BME and soil moisture sensors */
 lcd_t lcd;
 ds3231_t ds3231;
 struct bme280_dev dev;
+bme_acq_t bmeAcq[BME_NUM_SENSORS];
+uint8_t bmeAddrs[BME_NUM_SENSORS] = {BME280_I2C_ADDR_PRIM, BME280_I2C_ADDR_SEC};	// Canopy, soil level
+climate_t bmeClimate[BME_NUM_SENSORS];
+#ifndef BME_STREAM_MODE
+adapt_sched_t bmeTempSched[BME_NUM_SENSORS];
+adapt_sched_t bmeHumSched[BME_NUM_SENSORS];
+#endif
+filter_t bmeTempFilter[BME_NUM_SENSORS];
+filter_t bmeHumFilter[BME_NUM_SENSORS];
+soil_moisture_sensor_t soilSensor;
+adapt_sched_t soilSched;
+filter_t soilFilter;
+filter_t rtcTempFilter;
 mcp23017_t ioExpander;
 keypad_t keypad;
 
@@ -21,52 +34,157 @@ uint8_t degreeSymLoc = 3;
 unsigned char humiditySym[] = {0x04,0x04,0x0A,0x0A,0x11,0x11,0x11,0x0E};
 uint8_t humiditySymLoc = 4;
 
+/* Water Content Symbol */
+unsigned char soilSenSymb[] = {0x0E,0x11,0x11,0x1F,0x11,0x11,0x0E,0x00};
+uint8_t soilSenSymLoc = 5;
+
 void setTime(ds3231_t *ds3231P, lcd_t *lcdP, keypad_t *keypad);
 static uint32_t readDigit(keypad_t *keypadP, char *str);
 static void printErrorMessage(lcd_t *lcdP, char *msg);
+static void handleKeyPress(char key);
+static void printResetCause(lcd_t *lcdP);
+static void failSafe(void);
+static bool bootBuildSymbols(void);
+static bool bootInitBME(void);
+static void bmePublish(void *objP, const struct bme280_data *dataP);
+#ifndef BME_STREAM_MODE
+static void scheduleBme(void);
+#endif
+static void soilPublish(void *objP, const soil_moisture_sensor_t *sensorP);
+static void scheduleSoil(void);
+#ifndef RTC_TICK_MODE
+static void nightModeInit(void);
+static void displayOffCB(void *objP);
+static void displayOnCB(void *objP);
+#endif
 
-static bool updateFlag = false;
+static volatile bool updateFlag = false;	// Set by Alarm 2 callback
+static bool diagScreen = false;				// Diagnostics screen is showing instead of time/sensors
+static uint8_t bmeCount = 0;				// Sensors found, packed at the front of bmeAcq[]
+static bme_acq_t *bmeShown = NULL;			// Sensor on the main screen. DS3231 temperature is shown if none
+static uint8_t envSensor = ENV_PAGE_OFF;	// Sensor on the environment page
+static bme_profile_t bmeProfile = BME_PROFILE_WEATHER;
+static bool soilPage = false;				// Soil moisture page is showing
+static bool displayDark = false;			// LCD blanked for the night
+static bool displayDirty = false;			// displayDark changed, the LCD doesn't know yet
 int main(void)
 {
  	/* Initializes MCU, drivers and middleware */
- 	atmel_start_init();	  	// Start free running timer  	startMillisTimer(); 	/* Initialize keypad */ 	keypadInit(&keypad);
+ 	atmel_start_init();	  	// Start free running timer  	startMillisTimer();	
+	/* Supervise the main loop from here on. Relay is forced off before any watchdog reset */
+	watchdogInit();
+	watchdogSetFailSafeCB(failSafe);
+	watchdogEnableTask(WDG_TASK_MAIN_LOOP, WDG_MAIN_LOOP_DEADLINE_MS);
+	
+	/* Start the LCD power-on clock. Its >15ms wait runs while the I2C devices below are set up */
+	lcdPowerOn(&lcd, &ioExpander, &DDRB, &PORTB, PINB0, PINB1, PINB2, true, false);
+	
+ 	/* Initialize keypad */ 	keypadInit(&keypad);	
+	/* ADC conversions are collected from ADC_vect from here on */
+	adcEngineInit();
+	soilSensInit(&soilSensor, soilPublish, NULL);
+	soilSensSetCalibration(&soilSensor, SOIL_CAL_WET_RAW, SOIL_CAL_DRY_RAW);
+	adaptSchedInit(&soilSched, SOIL_SCHED_MIN_MS, SOIL_SCHED_MAX_MS, SOIL_DEAD_BAND, SOIL_SLOPE_PER_MIN);
+	filterInit(&soilFilter, SOIL_FILTER_SHIFT, SOIL_REJECT_BAND);
+	filterInit(&rtcTempFilter, RTC_TEMP_FILTER_SHIFT, RTC_TEMP_REJECT_BAND);
+
  	/* Initialize I2C */  	i2cMasterInit(0);
   	/* Initialize mcp23017 */  	mcp23017Init(&ioExpander, 0, &DDRB, &PORTB, PINB3); // Pin B 3 is reset pin
+	/* Initialize and Configure RTC. Alarm 1 is shared by the software alarms */
+	ds3231Init(&ds3231);
+	alarmMuxInit(&ds3231);
  	
- 	/* Initialize LCD */
- 	lcdInit(&lcd, &ioExpander, &DDRB, &PORTB, PINB0, PINB1, PINB2, true, false);
-
-// 	/* Initialize bme sensor */
-// 	uint8_t devAddr = BME280_I2C_ADDR_PRIM;
-// 	initBME(&dev, userI2cRead, userI2cWrite, userDelayUs, &devAddr);
-// 	
- 	/* Initialize and Configure RTC */
- 	ds3231Init(&ds3231);
-	 
- 	// Set Alarm 2 to occur every minute
+ 	// Alarm 2 time for the once a minute display refresh
  	uint8_t a2Time[4] = {00, 00, 00, 00};	 
+#ifdef RTC_TICK_MODE
+	// Count seconds off the 1Hz output: minute updates cost no I2C at all
+	ds3231SetTickMode(&ds3231, true, rtcTick, NULL);
+#else
+ 	// Set Alarm 2 to occur every minute
 	ds3231SetAlarm2(&ds3231, a2Time, A2_MATCH_ONCE_PER_MIN, setUpdateFlag, NULL);
+#endif
+	
+	/* Finish LCD init, only waiting out what is left of the power-on delay */
+	lcdInitComplete(&lcd);
+	printResetCause(&lcd);
+	
+	/* First frame */
+	printTime(&lcd, &ds3231);
+	bootFirstFrame();
+	
+	/* Non critical init runs once the time is showing */
+	bootDefer(bootBuildSymbols);
+	bootDefer(bootInitBME);
+	while (bootRunDeferred())
+		watchdogCheckIn(WDG_TASK_MAIN_LOOP);
  	
 	// Set time 
- 	printTime(&lcd, &ds3231);
- 	printSymbols(&lcd);
  	setTime(&ds3231, &lcd, &keypad);
-	/* Build and print special symbols */
+#ifdef RTC_TICK_MODE
+	/* Software alarms can't reach the pin in tick mode, so no night mode. Something must still refresh the
+	   display: the ticks, or Alarm 2 if they can't start (no valid time to count from) */
+	if (!ds3231.tickMode && !ds3231SetTickMode(&ds3231, true, rtcTick, NULL))
+		ds3231SetAlarm2(&ds3231, a2Time, A2_MATCH_ONCE_PER_MIN, setUpdateFlag, NULL);
+#else
+	nightModeInit();
+#endif
+	/* Alarm 2 fires every minute. Leave room for a couple of missed polls */
+	watchdogEnableTask(WDG_TASK_DISPLAY, WDG_DISPLAY_DEADLINE_MS);
 
+	/* Idle between loop passes. Any interrupt wakes us up, the 1ms timer tick keeps the keypad scanned */
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	
  	char s;
  	while(1)
  	{
+		PROF_ENTER(PROF_LOOP);
+		watchdogCheckIn(WDG_TASK_MAIN_LOOP);
  		s = getKeyPress(&keypad);
+		if (s != '\0')
+			handleKeyPress(s);
+		
+		PROF_ENTER(PROF_RTC_POLL);
  		ds3231Poll(&ds3231);
- 		if(updateFlag)
+		PROF_EXIT(PROF_RTC_POLL);
+		
+		/* Night mode alarms run from ds3231Poll: only flag there, the LCD is written from here */
+		if (displayDirty)
+		{
+			displayDirty = false;
+			if (displayDark)
+				lcdNoDisplay(&lcd);
+			else
+				lcdDisplay(&lcd);
+		}
+		
+		for (uint8_t i = 0; i < bmeCount; i++)
+			bmeAcqService(&bmeAcq[i]);
+		adcEngineService();
+		soilSensService(&soilSensor);
+#ifndef BME_STREAM_MODE
+		scheduleBme();
+#endif
+		scheduleSoil();
+		
+		if(atomicTestAndClear(&updateFlag))
+		{
+			watchdogCheckIn(WDG_TASK_DISPLAY);
+			if (!diagScreen)
  		{
  			printTime(&lcd, &ds3231);
- 			//if(!getSensorDataForcedMode(&lcd, &dev))//
- 			//{//
- 				////print error//
- 			//}
- 			updateFlag = false;
- 		}
+				if (bmeShown == NULL)
+					printRtcTemperature(&lcd, &ds3231);
+			}
+		}
+		PROF_EXIT(PROF_LOOP);
+
+		/* A quiet ADC burst converts in noise reduction sleep instead, which also stops the TWI clock */
+		PROF_ENTER(PROF_IDLE);
+		if (adcEngineQuietPending() && !returnBusy())
+			adcEngineQuietSleep();
+		else
+			sleep_mode();
+		PROF_EXIT(PROF_IDLE);
  	}
 	
 }
@@ -76,6 +194,21 @@ void setUpdateFlag()
 {
 	updateFlag = true;
 }
+
+#ifdef RTC_TICK_MODE
+/* 1Hz tick callback: refresh the display on the minute like the Alarm 2 callback would. Comparing minutes also
+   catches a rollover that an hourly resync stepped over */
+void rtcTick(void *objP)
+{
+	static uint8_t lastMinute = 0xFF;
+	
+	if (ds3231.time[TIME_UNITS_MIN] != lastMinute)
+	{
+		lastMinute = ds3231.time[TIME_UNITS_MIN];
+		updateFlag = true;
+	}
+}
+#endif
 
 /* Print time on LCD */
 void printTime(lcd_t *lcdP, ds3231_t *ds3231P)
@@ -127,58 +260,45 @@ void printSymbols(lcd_t *lcdP)
 	lcdSetCursor(lcdP, 0,7);
 	lcdPrintSymbol(lcdP, calSymLoc);
 	
-	/* Print moisture Symbol */	
+	/* Build moisture Symbol. It shows on the soil page */
+	lcdBuildSym(lcdP, soilSenSymLoc, soilSenSymb);
 	
 	lcdHome(lcdP);
 }
 
-/* Print BME280 temperature, humidity, and pressure */
-void printBMEdata(lcd_t *lcdP, struct bme280_data *comp_data)
+/* Print BME280 temperature (F) and humidity (%RH) with two decimals, integer math only */
+void printBMEdata(lcd_t *lcdP, const bme_display_t *dispP)
 {
-	
-	float temp, press, hum;
-		temp = 0.01f * comp_data->temperature;
-		press = 0.0001f * comp_data->pressure;
-		hum = 1.0f / 1024.0f * comp_data->humidity;
-	
-	#ifdef BME280_FLOAT_ENABLE
-		temp = comp_data->temperature;
-		press = 0.01 * comp_data->pressure;
-		hum= comp_data->humidity;
-	#else
-	#ifdef BME280_64BIT_ENABLE
-		temp = 0.01f * comp_data->temperature;
-		press = 0.0001f * comp_data->pressure;
-		hum = 1.0f / 1024.0f * comp_data->humidity;
-	#else
-		temp = 0.01f * comp_data->temperature;
-		press = 0.01f * comp_data->pressure;
-		hum = 1.0f / 1024.0f * comp_data->humidity;
-	#endif
-	#endif
-	
-	/* Print temperature */
 	char lcdBuff[20] = {0}; // lcd buffer
 	
-	temp = (temp * 1.8) + 32; //convert to F
-	
-	/* Get interger and fractional value to print on lcd (floats don't work)*/
-	unsigned int intergralVal = temp; 
-	unsigned int fractionalVal = (temp - (uint32_t)temp) * 100;
-	
-	snprintf(lcdBuff, 20, "%u.%02u", intergralVal, fractionalVal);
+	/* Print temperature */
+	snprintf(lcdBuff, 20, "%s%u.%02u", dispP->tempF100 < 0 ? "-" : "", abs(dispP->tempF100) / 100,
+			 abs(dispP->tempF100) % 100);
 	lcdSetCursor(lcdP, 1, 1);
 	lcdPrint(lcdP, lcdBuff); // print
 	
 	/* Print humidity */
-	intergralVal = hum;
-	fractionalVal = (hum - (uint32_t)hum) * 100;
-	
-	snprintf(lcdBuff, 20, "%u.%02u", intergralVal, 3);
+	snprintf(lcdBuff, 20, "%u.%02u", dispP->humidity100 / 100, dispP->humidity100 % 100);
 	lcdSetCursor(lcdP, 1, 10);
 	lcdPrint(lcdP, lcdBuff); // Print
 }
 
+/* Print the smoothed DS3231 die temperature in the BME temperature slot, in F with two decimals */
+void printRtcTemperature(lcd_t *lcdP, ds3231_t *ds3231P)
+{
+	int16_t quarterC;
+	if (!ds3231GetTemperature(ds3231P, &quarterC))
+		return;
+	
+	// 0.25C steps to C x100 for the filter, then F x100
+	int16_t f100 = bmeAcqC100ToF100(filterUpdate(&rtcTempFilter, quarterC * 25));
+	char lcdBuff[20] = {0};
+	
+	snprintf(lcdBuff, 20, "%s%u.%02u", f100 < 0 ? "-" : "", abs(f100) / 100, abs(f100) % 100);
+	lcdSetCursor(lcdP, 1, 1);
+	lcdPrint(lcdP, lcdBuff);
+}
+
 /* Initialize a BME sensor */
 uint8_t initBME(struct bme280_dev *sensor, int8_t (*userI2cRead)(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr),
 				int8_t (*userI2cWrite)(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr),
@@ -188,13 +308,13 @@ uint8_t initBME(struct bme280_dev *sensor, int8_t (*userI2cRead)(uint8_t reg_add
 {
 	int8_t rslt = BME280_OK;
 
-	dev.intf_ptr = i2cAddr;
-	dev.intf = BME280_I2C_INTF;
-	dev.read = userI2cRead;
-	dev.write = userI2cWrite;
-	dev.delay_us = userDelayUs;
+	sensor->intf_ptr = i2cAddr;
+	sensor->intf = BME280_I2C_INTF;
+	sensor->read = userI2cRead;
+	sensor->write = userI2cWrite;
+	sensor->delay_us = userDelayUs;
 
-	rslt = bme280_init(&dev);
+	rslt = bme280_init(sensor);
 	return rslt;
 } 
 
@@ -245,52 +365,6 @@ void userDelayUs (uint32_t period, void *intf_ptr)
 	micro_delay(period);
 }
 
-/* BME Function to execute a sensor read */
-int8_t getSensorDataForcedMode(lcd_t *lcdP, struct bme280_dev *dev)
-{
-    int8_t rslt;
-    uint8_t settings_sel;
-	uint32_t req_delay;
-    struct bme280_data comp_data;
-
-    /* Recommended mode of operation: Indoor navigation */
-    dev->settings.osr_h = BME280_OVERSAMPLING_1X;
-    dev->settings.osr_p = BME280_OVERSAMPLING_16X;
-    dev->settings.osr_t = BME280_OVERSAMPLING_2X;
-    dev->settings.filter = BME280_FILTER_COEFF_16;
-
-    settings_sel = BME280_OSR_PRESS_SEL | BME280_OSR_TEMP_SEL | BME280_OSR_HUM_SEL | BME280_FILTER_SEL;
-
-    rslt = bme280_set_sensor_settings(settings_sel, dev);
-	
-	if (rslt != BME280_OK)
-		return rslt;
-	
-	/*Calculate the minimum delay required between consecutive measurement based upon the sensor enabled
-     *  and the oversampling configuration. */
-    req_delay = bme280_cal_meas_delay(&dev->settings) * 1000;
-	
-
-	/* Get sensor data */
-	rslt = bme280_set_sensor_mode(BME280_FORCED_MODE, dev);
-		
-	if (rslt != BME280_OK)
-		return rslt;
-	/* Wait for the measurement to complete and print data @25Hz */
-	dev->delay_us(req_delay, dev->intf_ptr);
-	rslt = bme280_get_sensor_data(BME280_ALL, &comp_data, dev);
-		
-	if (rslt != BME280_OK)
-		return rslt;
-		
-	dev->delay_us(1000000, dev->intf_ptr);
-
-	
-    printBMEdata(lcdP, &comp_data);
-		
-    return rslt;
-}
-
 void setTime(ds3231_t *ds3231P, lcd_t *lcdP, keypad_t *keypad)
 {
 	uint8_t time[7] = {0};
@@ -299,6 +373,9 @@ void setTime(ds3231_t *ds3231P, lcd_t *lcdP, keypad_t *keypad)
 	char message[] = "Invalid Time";
 	lcdSetCursor(lcdP, 0, 1);
 	
+	/* The user must keep typing: a stuck keypad scan still trips the watchdog */
+	watchdogEnableTask(WDG_TASK_USER_INPUT, WDG_USER_INPUT_DEADLINE_MS);
+	
 	uint8_t i = TIME_UNITS_HR;
 	while(i != TIME_UNITS_TOTAL)
 	{
@@ -311,6 +388,7 @@ void setTime(ds3231_t *ds3231P, lcd_t *lcdP, keypad_t *keypad)
 			
 			if(string[0] < '0' || string[0] > '9')
 			{
+				watchdogDisableTask(WDG_TASK_USER_INPUT);
 				printErrorMessage(lcdP, message);
 				return;
 			}	
@@ -348,16 +426,27 @@ void setTime(ds3231_t *ds3231P, lcd_t *lcdP, keypad_t *keypad)
 		}
 	}
 	
+	watchdogDisableTask(WDG_TASK_USER_INPUT);
 	if (!ds3231SetTime(&ds3231, time))
 		printErrorMessage(lcdP, message);
+	else
+		alarmMuxReschedule();
 }
 
 static uint32_t readDigit(keypad_t *keypadP, char *str)
 {
 	unsigned int digit = 0;
 	char s = '\0';
+	uint32_t start = getMillis();
 	while(s == '\0')
+	{
+		// Give up if nobody is typing. Caller sees '\0' and aborts
+		if (getMillis() - start > KEY_TIMEOUT_MS)
+			return 0;
+		watchdogCheckIn(WDG_TASK_MAIN_LOOP);
 		s = getKeyPress(keypadP);
+	}
+	watchdogCheckIn(WDG_TASK_USER_INPUT);
 		
 	sscanf(&s, "%1u", &digit);
 	
@@ -368,6 +457,161 @@ static uint32_t readDigit(keypad_t *keypadP, char *str)
 	return digit;
 }
 
+/* Show why the last reset happened, if it was the watchdog */
+static void printResetCause(lcd_t *lcdP)
+{
+	wdg_reset_cause_t cause;
+	if (!watchdogGetResetCause(&cause))
+		return;
+	
+	char lcdBuff[20] = {0};
+	lcdSetCursor(lcdP, 0, 0);
+	if (cause.task == WDG_UNKNOWN_TASK)
+		snprintf(lcdBuff, 20, "WDT rst #%u", cause.resetCount);
+	else
+		snprintf(lcdBuff, 20, "WDT rst #%u t:%u", cause.resetCount, cause.task);
+	lcdPrint(lcdP, lcdBuff);
+	
+	lcdSetCursor(lcdP, 1, 0);
+	snprintf(lcdBuff, 20, "I2C s:%02x a:%02x", cause.i2cState, cause.i2cAddr);
+	lcdPrint(lcdP, lcdBuff);
+	
+	// Hold the message for 2s without starving the watchdog
+	for (uint8_t i = 0; i < 20; i++)
+	{
+		watchdogCheckIn(WDG_TASK_MAIN_LOOP);
+		milli_delay(100);
+	}
+	lcdClear(lcdP);
+}
+
+/* Deferred boot step: build and print the CGRAM symbols */
+static bool bootBuildSymbols(void)
+{
+	printSymbols(&lcd);
+	return true;
+}
+
+/* Deferred boot step: BME280 chip id and calibration reads, for each address that answers */
+static bool bootInitBME(void)
+{
+	struct bme280_settings bmeSettings;
+	bmeProfileGetSettings(bmeProfile, &bmeSettings);
+	
+	for (uint8_t i = 0; i < BME_NUM_SENSORS; i++)
+	{
+		/* dev is shared: each acquisition keeps its own address and calibration copy */
+		if (initBME(&dev, userI2cRead, userI2cWrite, userDelayUs, &bmeAddrs[i]) != BME280_OK)
+			continue;
+		
+		climateReset(&bmeClimate[bmeCount]);
+		filterInit(&bmeTempFilter[bmeCount], BME_FILTER_SHIFT, BME_TEMP_REJECT_BAND);
+		filterInit(&bmeHumFilter[bmeCount], BME_FILTER_SHIFT, BME_HUM_REJECT_BAND);
+		bme_acq_t *acqP = &bmeAcq[bmeCount++];
+		bmeAcqInit(acqP, &dev, bmeAddrs[i], &bmeSettings, bmePublish, acqP);
+#ifdef BME_STREAM_MODE
+		// Free running at the profile's standby time, ~1Hz for the default weather profile. That one has the IIR
+		// filter off, so only the median/EMA in bmePublish smooths the readings
+		bmeAcqStartStream(acqP);
+#else
+		// First sample on the next pass, then each channel sets its own pace
+		adaptSchedInit(&bmeTempSched[bmeCount - 1], BME_SCHED_MIN_MS, BME_SCHED_MAX_MS, BME_TEMP_DEAD_BAND,
+					   BME_TEMP_SLOPE_PER_MIN);
+		adaptSchedInit(&bmeHumSched[bmeCount - 1], BME_SCHED_MIN_MS, BME_SCHED_MAX_MS, BME_HUM_DEAD_BAND,
+					   BME_HUM_SLOPE_PER_MIN);
+#endif
+	}
+	
+	bmeShown = bmeCount ? &bmeAcq[0] : NULL;
+	return bmeCount != 0;
+}
+
+/* BME acquisition callback: a new measurement is ready. objP is the bme_acq_t it came from */
+static void bmePublish(void *objP, const struct bme280_data *dataP)
+{
+	uint8_t sensor = (bme_acq_t *)objP - bmeAcq;
+	bme_display_t disp;
+	
+	bmeAcqToDisplay(dataP, &disp);
+#ifndef BME_STREAM_MODE
+	/* The schedulers see the raw readings so a real change speeds sampling up without waiting for the median */
+	adaptSchedUpdate(&bmeTempSched[sensor], disp.tempC100);
+	adaptSchedUpdate(&bmeHumSched[sensor], (int16_t)disp.humidity100);
+#endif
+	
+	disp.tempC100 = filterUpdate(&bmeTempFilter[sensor], disp.tempC100);
+	disp.tempF100 = bmeAcqC100ToF100(disp.tempC100);
+	disp.humidity100 = (uint16_t)filterUpdate(&bmeHumFilter[sensor], (int16_t)disp.humidity100);
+	climateUpdate(&bmeClimate[sensor], disp.tempC100, disp.humidity100);
+	
+	if (envSensor == sensor)
+		printEnvironment(&lcd, sensor);
+	else if (objP == bmeShown && !diagScreen)
+		printBMEdata(&lcd, &disp);
+}
+
+#ifndef BME_STREAM_MODE
+/**
+*	Trigger every sensor once any channel of any sensor is due, so the shortest interval sets one shared pace.
+*	The conversions then overlap and the bus sees one burst of reads per round instead of one per sensor. A
+*	sensor still busy from the last round is left out of both the due check and the round, and rejoins on the
+*	next, so a busy sensor can't keep the round due and re-trigger the ones that already finished. A profile
+*	change picked while a sensor was busy lands here
+*/
+static void scheduleBme(void)
+{
+	uint32_t now = getMillis();
+	bool due = false;
+	
+	for (uint8_t i = 0; i < bmeCount; i++)
+	{
+		if (!bmeAcqIsBusy(&bmeAcq[i]))
+			due = due || adaptSchedDue(&bmeTempSched[i], now) || adaptSchedDue(&bmeHumSched[i], now);
+	}
+	if (!due)
+		return;
+	
+	for (uint8_t i = 0; i < bmeCount; i++)
+	{
+		if (bmeAcqIsBusy(&bmeAcq[i]))
+			continue;
+		bmeProfileApply(&bmeAcq[i], bmeProfile);
+		if (bmeAcqStart(&bmeAcq[i]))
+		{
+			adaptSchedStarted(&bmeTempSched[i], now);
+			adaptSchedStarted(&bmeHumSched[i], now);
+		}
+	}
+}
+#endif
+
+/* Start a soil reading when its schedule is due. The relay is only closed for the settle time plus the burst */
+static void scheduleSoil(void)
+{
+	uint32_t now = getMillis();
+	
+	if (adaptSchedDue(&soilSched, now) && readSens(&soilSensor))
+		adaptSchedStarted(&soilSched, now);
+}
+
+/* Soil reading complete */
+static void soilPublish(void *objP, const soil_moisture_sensor_t *sensorP)
+{
+	if (sensorP->state != MS_READ_COMPLETE)
+		return;
+	
+	adaptSchedUpdate(&soilSched, (int16_t)sensorP->moisture);
+	filterUpdate(&soilFilter, (int16_t)sensorP->moisture);
+	if (soilPage)
+		printSoilMoisture(&lcd, sensorP);
+}
+
+/* Watchdog fail-safe, runs in the WDT ISR right before the reset: leave the pump/sensor power off */
+static void failSafe(void)
+{
+	soilSenPwrRelay(false);
+}
+
 static void printErrorMessage(lcd_t *lcdP, char *msg)
 {
 	for (uint8_t i = 0; i < 16; i++)
@@ -378,3 +622,291 @@ static void printErrorMessage(lcd_t *lcdP, char *msg)
 	lcdPrint(lcdP, msg);
 	lcdHome(lcdP);
 }
+
+#ifndef RTC_TICK_MODE
+/* Blank the LCD between DISPLAY_OFF_HOUR and DISPLAY_ON_HOUR with two daily software alarms on RTC Alarm 1 */
+static void nightModeInit(void)
+{
+	epoch_t now;
+	
+	if (softClockIsValid())
+		now = softClockNow();
+	else if (!epochFromBcd(ds3231.time, &now))
+		return;
+	
+	// Next time each hour comes round, today or tomorrow
+	epoch_t midnight = now - now % EPOCH_SECS_PER_DAY;
+	epoch_t off = midnight + DISPLAY_OFF_HOUR * EPOCH_SECS_PER_HOUR;
+	epoch_t on = midnight + DISPLAY_ON_HOUR * EPOCH_SECS_PER_HOUR;
+	if (epochDiff(off, now) <= 0)
+		off += EPOCH_SECS_PER_DAY;
+	if (epochDiff(on, now) <= 0)
+		on += EPOCH_SECS_PER_DAY;
+	
+	alarmMuxAdd(off, EPOCH_SECS_PER_DAY, displayOffCB, NULL);
+	alarmMuxAdd(on, EPOCH_SECS_PER_DAY, displayOnCB, NULL);
+	
+	// Switched on during the night: the morning comes first
+	if (epochDiff(on, off) < 0)
+		displayOffCB(NULL);
+}
+
+static void displayOffCB(void *objP)
+{
+	displayDark = true;
+	displayDirty = true;
+}
+
+static void displayOnCB(void *objP)
+{
+	displayDark = false;
+	displayDirty = true;
+}
+#endif
+
+/* Main screen keys: 'D' steps through the diagnostics pages, '#' restarts the profiler window, 'C' shows RAM usage,
+   'B' shows boot timings, '*' shows RTC alarm stats, '0' steps through the sensors' climate pages, '1' selects the
+   next BME280 profile, '2' shows soil moisture, 'A' goes home */
+static void handleKeyPress(char key)
+{
+	/* The first key at night only brings the display back */
+	if (displayDark)
+	{
+		displayDark = false;
+		displayDirty = true;
+		return;
+	}
+	
+	switch (key)
+	{
+#ifdef PROFILER_ENABLE
+		case 'D':
+		{
+			static prof_section_t section = PROF_NUM_SECTIONS - 1;
+			section = (section + 1) % PROF_NUM_SECTIONS;
+			diagScreen = true;
+			envSensor = ENV_PAGE_OFF;
+			soilPage = false;
+			printDiagnostics(&lcd, section);
+			break;
+		}
+		case '#':
+			profilerReset();
+			break;
+#endif
+		case 'C':
+			diagScreen = true;
+			envSensor = ENV_PAGE_OFF;
+			soilPage = false;
+			printMemStats(&lcd);
+			break;
+		case 'B':
+			diagScreen = true;
+			envSensor = ENV_PAGE_OFF;
+			soilPage = false;
+			printBootTimes(&lcd);
+			break;
+		case '*':
+			diagScreen = true;
+			envSensor = ENV_PAGE_OFF;
+			soilPage = false;
+			printRtcLatency(&lcd, &ds3231);
+			break;
+		case '1':
+			diagScreen = true;
+			envSensor = ENV_PAGE_OFF;
+			soilPage = false;
+			bmeProfile = (bmeProfile + 1) % BME_NUM_PROFILES;
+			for (uint8_t i = 0; i < bmeCount; i++)
+			{
+#ifdef BME_STREAM_MODE
+				bmeAcqStop(&bmeAcq[i]);
+				bmeProfileApply(&bmeAcq[i], bmeProfile);
+				bmeAcqStartStream(&bmeAcq[i]);
+#else
+				bmeProfileApply(&bmeAcq[i], bmeProfile);
+#endif
+			}
+			printBmeProfile(&lcd, bmeProfile);
+			break;
+		case '0':
+			if (bmeCount == 0)
+				break;
+			diagScreen = true;
+			soilPage = false;
+			envSensor = envSensor < bmeCount - 1 ? envSensor + 1 : 0;
+			printEnvironment(&lcd, envSensor);
+			break;
+		case '2':
+			diagScreen = true;
+			envSensor = ENV_PAGE_OFF;
+			soilPage = true;
+			printSoilMoisture(&lcd, &soilSensor);
+			break;
+		case 'A':
+			if (diagScreen)
+			{
+				diagScreen = false;
+				envSensor = ENV_PAGE_OFF;
+				soilPage = false;
+				lcdClear(&lcd);
+				printSymbols(&lcd);
+				printTime(&lcd, &ds3231);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/* Print static RAM usage and free stack (now / worst case since reset) */
+void printMemStats(lcd_t *lcdP)
+{
+	mem_stats_t stats;
+	char lcdBuff[20] = {0};
+	
+	memStatsGet(&stats);
+	
+	lcdClear(lcdP);
+	snprintf(lcdBuff, 20, "RAM static %u", stats.staticBytes);
+	lcdPrint(lcdP, lcdBuff);
+	
+	lcdSetCursor(lcdP, 1, 0);
+	snprintf(lcdBuff, 20, "stk %u min %u", stats.freeNow, stats.minFree);
+	lcdPrint(lcdP, lcdBuff);
+	lcdHome(lcdP);
+}
+
+/* Print time to first frame and time until the deferred init finished */
+void printBootTimes(lcd_t *lcdP)
+{
+	boot_times_t times;
+	char lcdBuff[20] = {0};
+	
+	bootGetTimes(&times);
+	
+	lcdClear(lcdP);
+	snprintf(lcdBuff, 20, "1st frm %lums", (unsigned long)(times.firstFrameUs / 1000));
+	lcdPrint(lcdP, lcdBuff);
+	
+	lcdSetCursor(lcdP, 1, 0);
+	snprintf(lcdBuff, 20, "dfr %lums f:%02x", (unsigned long)(times.deferredUs / 1000), times.failedSteps);
+	lcdPrint(lcdP, lcdBuff);
+	lcdHome(lcdP);
+}
+
+/* Print RTC alarm latency (INT/SQW edge to alarm callback, last/worst case) and bus bytes saved by selective reads */
+void printRtcLatency(lcd_t *lcdP, ds3231_t *ds3231P)
+{
+	char lcdBuff[20] = {0};
+	uint32_t minutes = getMillis() / 60000;
+	
+	lcdClear(lcdP);
+	snprintf(lcdBuff, 20, "lat %lu/%luus", (unsigned long)ticksToMicroseconds(ds3231P->lastLatencyTicks),
+			 (unsigned long)ticksToMicroseconds(ds3231P->maxLatencyTicks));
+	lcdPrint(lcdP, lcdBuff);
+	
+	lcdSetCursor(lcdP, 1, 0);
+	snprintf(lcdBuff, 20, "saved %luB/min", (unsigned long)(minutes ? ds3231P->bytesSaved / minutes : 0));
+	lcdPrint(lcdP, lcdBuff);
+	lcdHome(lcdP);
+}
+
+/* Print a sensor's climate page: VPD now and averaged (kPa), dew point (F) and absolute humidity (g/m3) */
+void printEnvironment(lcd_t *lcdP, const uint8_t sensor)
+{
+	const climate_t *climateP = &bmeClimate[sensor];
+	char lcdBuff[20] = {0};
+	
+	lcdClear(lcdP);
+	if (climateP->samples == 0)
+	{
+		snprintf(lcdBuff, 20, "%u no data yet", sensor + 1);
+		lcdPrint(lcdP, lcdBuff);
+		lcdHome(lcdP);
+		return;
+	}
+	
+	uint16_t vpdAvg = climateVpdAverage(climateP);
+	snprintf(lcdBuff, 20, "%u VPD%u.%02u av%u.%02u", sensor + 1, climateP->vpdPa / 1000, (climateP->vpdPa % 1000) / 10,
+			 vpdAvg / 1000, (vpdAvg % 1000) / 10);
+	lcdPrint(lcdP, lcdBuff);
+	
+	// C x100 to F x10
+	int16_t dewF100 = bmeAcqC100ToF100(climateP->dewPointC100);
+	int16_t dewF10 = (dewF100 < 0 ? dewF100 - 5 : dewF100 + 5) / 10;
+	lcdSetCursor(lcdP, 1, 0);
+	snprintf(lcdBuff, 20, "Td%s%u.%uF AH%u.%ug", dewF10 < 0 ? "-" : "", abs(dewF10) / 10, abs(dewF10) % 10,
+			 climateP->absHumidity100 / 100, (climateP->absHumidity100 % 100) / 10);
+	lcdPrint(lcdP, lcdBuff);
+	lcdHome(lcdP);
+}
+
+/* Print smoothed soil moisture in percent with one decimal, the last raw average, its resolution and burst time */
+void printSoilMoisture(lcd_t *lcdP, const soil_moisture_sensor_t *sensorP)
+{
+	char lcdBuff[20] = {0};
+	adc_timing_t timing;
+	
+	lcdClear(lcdP);
+	lcdPrintSymbol(lcdP, soilSenSymLoc);
+	if (!filterIsValid(&soilFilter))
+	{
+		lcdPrint(lcdP, " no data yet");
+		lcdHome(lcdP);
+		return;
+	}
+	
+	uint16_t moisture = (uint16_t)filterGet(&soilFilter);
+	snprintf(lcdBuff, 20, " %u.%u%% dry", moisture / 10, moisture % 10);
+	lcdPrint(lcdP, lcdBuff);
+	
+	lcdSetCursor(lcdP, 1, 0);
+	adcEngineGetTiming(&sensorP->job, &timing);
+	snprintf(lcdBuff, 20, "raw%u %ub %lums", sensorP->rawSum / SOIL_SAMPLE_COUNT, timing.bits,
+			 (unsigned long)(timing.burstUs / 1000));
+	lcdPrint(lcdP, lcdBuff);
+	lcdHome(lcdP);
+}
+
+/* Print a BME280 profile: worst case conversion time and estimated sensor charge per sample */
+void printBmeProfile(lcd_t *lcdP, const bme_profile_t profile)
+{
+	bme_profile_info_t info;
+	char lcdBuff[20] = {0};
+	
+	if (!bmeProfileGetInfo(profile, &info))
+		return;
+	
+	lcdClear(lcdP);
+	snprintf(lcdBuff, 20, "%-8s %3ums", info.name, info.measMs);
+	lcdPrint(lcdP, lcdBuff);
+	
+	lcdSetCursor(lcdP, 1, 0);
+	snprintf(lcdBuff, 20, "%u.%uuC/sample", info.chargeNc / 1000, (info.chargeNc % 1000) / 100);
+	lcdPrint(lcdP, lcdBuff);
+	lcdHome(lcdP);
+}
+
+#ifdef PROFILER_ENABLE
+/* Print one profiler section: load and call count on the first row, worst case pass on the second */
+void printDiagnostics(lcd_t *lcdP, const prof_section_t section)
+{
+	prof_stats_t stats;
+	char lcdBuff[20] = {0};
+	
+	if (!profilerGetStats(section, &stats))
+		return;
+	
+	lcdClear(lcdP);
+	/* 4 + 5 + 1 + 6: all 16 columns with 100.0% and a saturated call count */
+	snprintf(lcdBuff, 20, "%-4s%3u.%u%%%6u", profilerGetName(section), stats.loadPermille / 10,
+			 stats.loadPermille % 10, stats.calls);
+	lcdPrint(lcdP, lcdBuff);
+	
+	lcdSetCursor(lcdP, 1, 0);
+	snprintf(lcdBuff, 20, "max %luus", (unsigned long)ticksToMicroseconds(stats.maxTicks));
+	lcdPrint(lcdP, lcdBuff);
+	lcdHome(lcdP);
+}
+#endif
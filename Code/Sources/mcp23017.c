@@ -22,7 +22,7 @@ static bool updateReg(mcp23017_t *deviceP,
 				bool updateType, 
 				const uint8_t newVal);
 
-static bool readReg(const uint8_t deviceAddr, const uint8_t regAddr, uint8_t *resp);
+static bool readReg(const uint8_t deviceAddr, const uint8_t regAddr, uint8_t *resp, const uint8_t size);
 static bool readAllRegs(mcp23017_t *deviceP);
 static void setupRegAddrs(uint8_t mcpRegAddr[], const bool bank);
 static uint8_t mcpGetAddr(uint8_t pin, uint8_t portAaddr, uint8_t portBaddr);
@@ -115,7 +115,7 @@ bool mcp23017SetPinPull(mcp23017_t *deviceP, const uint8_t port, const uint8_t p
 // Read a port's value
 bool mcp23017ReadPortLevel(mcp23017_t *deviceP, const uint8_t port,	uint8_t *dataBuff)
 {
-	return readReg(deviceP->addr, port ? deviceP->mcpRegAddrs[MCP23017_GPIOB] : deviceP->mcpRegAddrs[MCP23017_GPIOA], dataBuff);
+	return readReg(deviceP->addr, port ? deviceP->mcpRegAddrs[MCP23017_GPIOB] : deviceP->mcpRegAddrs[MCP23017_GPIOA], dataBuff, 1);
 }
 
 // Change the Iocon register of device
@@ -163,8 +163,8 @@ static bool updateReg(mcp23017_t *deviceP, const uint8_t regAddr, uint8_t pin, c
 	return status;
 }
 
-// Read a register using i2c
-static bool readReg(const uint8_t deviceAddr, const uint8_t regAddr, uint8_t *resp)
+// Read size consecutive registers using i2c, starting at regAddr
+static bool readReg(const uint8_t deviceAddr, const uint8_t regAddr, uint8_t *resp, const uint8_t size)
 {
 	bool status = false;
 	uint8_t dataP = regAddr;
@@ -174,7 +174,7 @@ static bool readReg(const uint8_t deviceAddr, const uint8_t regAddr, uint8_t *re
 	if(!i2cMasterTransmit(deviceAddr, &dataP, 1))
 		return status;
 	/* Block till i2c is finished sending register address */
-	if(i2cMasterRead(deviceAddr, resp, 1))
+	if(i2cMasterRead(deviceAddr, resp, size))
 		status = true;
 
 	return status;
@@ -200,17 +200,14 @@ static void setupRegAddrs(uint8_t mcpRegAddr[], const bool bank)
 	}
 }
 
-// REad all registers
+/**
+*	Read all registers in a single burst instead of one transfer per register. With IOCON.SEQOP = 0 (reset value)
+*	the address pointer auto-increments, and with bank = 0 the registers sit at 0x00-0x15, which is exactly how
+*	deviceP->registers is indexed.
+*/
 static bool readAllRegs(mcp23017_t *deviceP)
 {
-	for (int i = MCP23017_IODIRA; i < NUMBER_OF_REGS; i++)
-	{
-		uint8_t regAddr =  deviceP->mcpRegAddrs[i]; // acquire the address of specific register
-		uint8_t *dataP = &deviceP->registers[regAddr];
-		if(!readReg(deviceP->addr, regAddr, dataP))
-			return false; 
-	}
-	return true;
+	return readReg(deviceP->addr, deviceP->mcpRegAddrs[MCP23017_IODIRA], deviceP->registers, NUMBER_OF_REGS);
 }
 
 //get port address based on pin value 
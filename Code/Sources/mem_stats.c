@@ -0,0 +1,80 @@
+/*
+ * mem_stats.c
+ *
+ * Created: 10/19/2026 2:55:41 PM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "mem_stats.h"
+#include <avr/io.h>
+
+/* Linker symbols */
+extern uint8_t __data_start;
+extern uint8_t _end;
+extern uint8_t __stack;
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+void memStatsPaintStack(void) __attribute__((naked, used, section(".init1")));
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/* Smallest amount of free stack seen since reset. Walks the paint up from the end of .bss */
+uint16_t memStatsMinFreeStack(void)
+{
+	const uint8_t *p = &_end;
+	uint16_t count = 0;
+
+	while (p <= &__stack && *p == MEM_STATS_PAINT)
+	{
+		p++;
+		count++;
+	}
+	return count;
+}
+
+/* Free stack right now */
+uint16_t memStatsFreeNow(void)
+{
+	return (uint16_t)SP - (uint16_t)&_end;
+}
+
+/* Snapshot static usage, current and worst case free stack */
+void memStatsGet(mem_stats_t *statsP)
+{
+	statsP->staticBytes = (uint16_t)&_end - (uint16_t)&__data_start;
+	statsP->freeNow = memStatsFreeNow();
+	statsP->minFree = memStatsMinFreeStack();
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+/**
+*	Runs from .init1, before r1 is cleared and before .data/.bss are set up, so it is plain assembly touching only
+*	Z and r24/r25. Fills [_end, __stack] with the paint byte. SP is still RAMEND at this point.
+*/
+void memStatsPaintStack(void)
+{
+	__asm volatile (
+		"    ldi r30, lo8(_end)		\n"
+		"    ldi r31, hi8(_end)		\n"
+		"    ldi r24, %0			\n"
+		"    ldi r25, hi8(__stack)	\n"
+		"    rjmp 2f				\n"
+		"1:  st Z+, r24				\n"
+		"2:  cpi r30, lo8(__stack)	\n"
+		"    cpc r31, r25			\n"
+		"    brlo 1b				\n"
+		"    breq 1b				\n"
+		:
+		: "i" (MEM_STATS_PAINT)
+	);
+}
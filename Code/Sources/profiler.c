@@ -0,0 +1,125 @@
+/*
+ * profiler.c
+ *
+ * Created: 10/19/2026 11:22:10 AM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "profiler.h"
+
+#ifdef PROFILER_ENABLE
+
+#include "timer.h"
+#include <atomic.h>
+
+#define MAX_CALL_COUNT		(0xFFFF)
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+typedef struct prof_entry_s
+{
+	uint32_t startTick;
+	uint32_t totalTicks;
+	uint32_t maxTicks;
+	uint16_t calls;
+} prof_entry_t;
+
+/* Written from ISRs as well as the main loop */
+static volatile prof_entry_t profTable[PROF_NUM_SECTIONS];
+static uint32_t windowStart;
+
+static const char *const profNames[PROF_NUM_SECTIONS] =
+{
+	"LOOP", "LCD", "I2C", "DLY", "RTC", "ITMR", "ITWI", "IDLE"
+};
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/* Clear all sections and start a new measurement window */
+void profilerReset(void)
+{
+	ENTER_CRITICAL(R);
+	for (uint8_t i = 0; i < PROF_NUM_SECTIONS; i++)
+	{
+		profTable[i].startTick = profTable[i].totalTicks = profTable[i].maxTicks = 0;
+		profTable[i].calls = 0;
+	}
+	windowStart = getTicks();
+	EXIT_CRITICAL(R);
+}
+
+/* Mark the start of a pass through a section */
+void profilerEnter(const prof_section_t section)
+{
+	uint32_t now = getTicks();
+	ENTER_CRITICAL(E);
+	profTable[section].startTick = now;
+	EXIT_CRITICAL(E);
+}
+
+/* Mark the end of a pass through a section and accumulate it */
+void profilerExit(const prof_section_t section)
+{
+	uint32_t now = getTicks();
+	uint32_t start;
+
+	ENTER_CRITICAL(X);
+	start = profTable[section].startTick;
+	EXIT_CRITICAL(X);
+
+	profilerRecord(section, now - start);
+}
+
+/* Accumulate one pass of a known length in Timer1 ticks */
+void profilerRecord(const prof_section_t section, const uint32_t ticks)
+{
+	ENTER_CRITICAL(X);
+	volatile prof_entry_t *entryP = &profTable[section];
+
+	entryP->totalTicks += ticks;
+	if (ticks > entryP->maxTicks)
+		entryP->maxTicks = ticks;
+	if (entryP->calls < MAX_CALL_COUNT)
+		entryP->calls++;
+	EXIT_CRITICAL(X);
+}
+
+/* Snapshot a section's statistics. Load is in per-mille of the time since profilerReset */
+bool profilerGetStats(const prof_section_t section, prof_stats_t *statsP)
+{
+	if (section >= PROF_NUM_SECTIONS)
+		return false;
+
+	uint32_t window = getTicks() - windowStart;
+
+	ENTER_CRITICAL(S);
+	statsP->totalTicks = profTable[section].totalTicks;
+	statsP->maxTicks = profTable[section].maxTicks;
+	statsP->calls = profTable[section].calls;
+	EXIT_CRITICAL(S);
+
+	/* Scale down first so the multiply can't overflow on long windows */
+	uint32_t total = statsP->totalTicks;
+	while (window > 0x3FFFFF)
+	{
+		window >>= 1;
+		total >>= 1;
+	}
+	statsP->loadPermille = window ? (uint16_t)((total * 1000) / window) : 0;
+
+	return true;
+}
+
+/* Short (<= 4 char) section label for the diagnostics screen */
+const char *profilerGetName(const prof_section_t section)
+{
+	return section < PROF_NUM_SECTIONS ? profNames[section] : "";
+}
+
+#endif /* PROFILER_ENABLE */
@@ -0,0 +1,112 @@
+/*
+ * soft_clock.c
+ *
+ * Created: 10/19/2026 6:15:52 PM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "soft_clock.h"
+#include "timer.h"
+
+#define MIN_DRIFT_WINDOW_S		(30)			// Shorter windows can't resolve the drift
+#define MAX_DRIFT_WINDOW_S		(3600)
+#define MAX_CORRECTED_MS		(3600000UL)		// Keeps the correction multiply inside 32 bits
+#define MAX_SYNC_COUNT			(0xFFFF)
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+static epoch_t baseTime;		// RTC time latched at the last sync
+static uint32_t baseMs;			// getMillis() at the start of that RTC second
+static bool baseExact;			// baseMs is a true second boundary (alarm edge)
+static bool valid;
+static soft_clock_stats_t stats;
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+static epoch_t softClockAt(const uint32_t ms);
+
+static int32_t driftCorrectionMs(const uint32_t elapsedMs);
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/**
+*	Latch a fresh RTC reading.
+*	@param	rtcTime: time read from the RTC
+*	@param	syncMs: getMillis() when that RTC second started (alarm edge), or when it was read
+*	@param	exact: syncMs is a real second boundary. Only exact syncs are used to measure drift
+*/
+void softClockSync(const epoch_t rtcTime, const uint32_t syncMs, const bool exact)
+{
+	uint32_t rtcElapsed = rtcTime - baseTime;
+	
+	if (valid && rtcElapsed <= MAX_DRIFT_WINDOW_S)
+	{
+		uint32_t elapsedMs = syncMs - baseMs;
+		int32_t errMs = (int32_t)(elapsedMs - driftCorrectionMs(elapsedMs)) - (int32_t)(rtcElapsed * 1000);
+		stats.lastErrorMs = errMs > INT16_MAX ? INT16_MAX : (errMs < INT16_MIN ? INT16_MIN : (int16_t)errMs);
+
+		if (exact && baseExact && rtcElapsed >= MIN_DRIFT_WINDOW_S)
+		{
+			// Raw timer error: ms gained per 1000 RTC seconds == ppm
+			errMs = (int32_t)elapsedMs - (int32_t)(rtcElapsed * 1000);
+			int32_t maxErrMs = (int32_t)rtcElapsed * SOFT_CLOCK_MAX_PPM / 1000;
+
+			// A bigger step means the time was set, not that the timer drifted
+			if (errMs <= maxErrMs && errMs >= -maxErrMs)
+			{
+				int32_t ppm = errMs * 1000 / (int32_t)rtcElapsed;
+				stats.driftPpm += (int16_t)((ppm - stats.driftPpm) / 4);
+			}
+		}
+	}
+
+	baseTime = rtcTime;
+	baseMs = syncMs;
+	baseExact = exact;
+	valid = true;
+	if (stats.syncs < MAX_SYNC_COUNT)
+		stats.syncs++;
+}
+
+/* False until the first RTC read */
+bool softClockIsValid(void)
+{
+	return valid;
+}
+
+/* Current time, drift corrected */
+epoch_t softClockNow(void)
+{
+	return softClockAt(getMillis());
+}
+
+/* Drift estimate and last sync error */
+void softClockGetStats(soft_clock_stats_t *statsP)
+{
+	*statsP = stats;
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+/* Extrapolate from the last sync to a getMillis() timestamp */
+static epoch_t softClockAt(const uint32_t ms)
+{
+	uint32_t elapsed = ms - baseMs;
+	return baseTime + (elapsed - driftCorrectionMs(elapsed)) / 1000;
+}
+
+/* Timer drift over elapsedMs: elapsedMs * ppm / 1e6, pre-shifted by 16 to stay in 32 bits */
+static int32_t driftCorrectionMs(const uint32_t elapsedMs)
+{
+	uint32_t capped = elapsedMs < MAX_CORRECTED_MS ? elapsedMs : MAX_CORRECTED_MS;
+	return ((int32_t)(capped >> 4) * stats.driftPpm) / 62500;
+}
@@ -9,9 +9,12 @@
 /*                     Includes/Constants                               */
 /************************************************************************/
 #include "timer.h"
+#include "atomic_access.h"
+#include "profiler.h"
+#include <util/delay.h>
 
 #define MAX_INT32_VAL	0xFFFFFFFF
-static uint32_t milliSecond;
+static volatile uint32_t milliSecond;	// Updated from TIMER1_COMPA ISR
 
 /************************************************************************/
 /*                      Public Functions Implementations                */
@@ -23,15 +26,15 @@ static uint32_t milliSecond;
 void startMillisTimer()
 {
 	/* Reset millisecond */
-	milliSecond = 0;
-	/*prescale by 1024 */
-	TCCR1B = 0x05;
-	/* Output compare A: 0x12 == approx 1.5sec*/
-	OCR1A = 15;
-	/* Enable Output compare match interrupt */
-	TIMSK1 |= (1 << OCIE1A);
+	atomicWrite32(&milliSecond, 0);
+	/* CTC mode, prescale by 64: one tick every 4us. Hardware clears TCNT1 on compare match */
+	TCCR1B = (1 << WGM12) | (1 << CS11) | (1 << CS10);
+	/* Output compare A: 250 ticks == 1ms */
+	OCR1A = TICKS_PER_MILLISECOND - 1;
 	/* Restart tick count to 0 */
 	TCNT1 = 0;
+	/* Enable Output compare match interrupt */
+	TIMSK1 |= (1 << OCIE1A);
 }
 
 /* Stop timer */
@@ -47,50 +50,70 @@ void stopMillisTimer()
 void updateMillis()
 {
 	milliSecond = milliSecond < MAX_INT32_VAL ? milliSecond + 1 : 0;
+}
 
-	/*reset tick count*/
-	TCNT1 = 0;
+/**
+*	Move the clock on by ticks (less than TICKS_PER_MILLISECOND) for time Timer1 spent halted, e.g. in ADC Noise
+*	Reduction sleep. TCNT1 is never written with the compare value itself: that write would block the match and
+*	let Timer1 run on to 0xFFFF, so landing there counts the millisecond right away instead (4us early).
+*/
+void advanceMillisTimer(const uint8_t ticks)
+{
+	ENTER_CRITICAL(T);
+	uint16_t count = TCNT1 + ticks;
+	if (count >= TICKS_PER_MILLISECOND - 1)
+	{
+		/* Skipping over the compare match: the ISR won't count this millisecond */
+		updateMillis();
+		count = count >= TICKS_PER_MILLISECOND ? count - TICKS_PER_MILLISECOND : 0;
+	}
+	TCNT1 = count;
+	EXIT_CRITICAL(T);
 }
 
-/* Retrieve milliseconds count */
+/* Retrieve milliseconds count. Snapshot with interrupts masked so the ISR can't tear the 4 byte read */
 uint32_t getMillis()
 {
-	return milliSecond;
+	return atomicRead32(&milliSecond);
 }
 
-/* Execute a delay in milliseconds */
-void milli_delay(uint32_t milliseconds)
+/**
+*	Retrieve a free running Timer1 tick count (TICKS_PER_MILLISECOND per ms, 4us resolution).
+*	Wraps every ~4.7 hours, so only use differences of two readings. Inside TIMER1_COMPA_vect it reads a
+*	millisecond short until updateMillis has run.
+*/
+uint32_t getTicks()
 {
+	uint32_t ms;
+	uint8_t ticks;
 	
-	/* Prescale by 1024 */
-	TCCR1B = 0x05;
-	/* Reset tick */
-	TCNT1 = 0;
+	ENTER_CRITICAL(T);
+	ms = milliSecond;
+	ticks = TCNT1;
+	/* Compare match already happened but the ISR hasn't run yet: count the missing millisecond */
+	if ((TIFR1 & (1 << OCF1A)) && ticks < TICKS_PER_MILLISECOND - 1)
+		ms++;
+	EXIT_CRITICAL(T);
 	
-	short currTime = 0;
-	while(currTime < milliseconds)
-	{
-		while(TCNT1 < 15);
-		TCNT1 = 0;
-		currTime++;
-	}
+	return ms * TICKS_PER_MILLISECOND + ticks;
 }
 
-/* Execute a delay in microseconds */
-void micro_delay(uint32_t micro)
+/* Execute a delay in milliseconds. Busy waits without touching Timer1 so the millisecond count keeps running */
+void milli_delay(uint32_t milliseconds)
 {
-	/* No prescaler */
-	TCCR1B = 0x02;
-	/* Reset tick */
-	TCNT1 = 0;
+	PROF_ENTER(PROF_DELAY);
+	while (milliseconds--)
+		_delay_ms(1);
+	PROF_EXIT(PROF_DELAY);
+}
 
-	short currTime = 0;
-	while(currTime < micro)
-	{
-		while(TCNT1 < 2);
-		TCNT1 = 0;
-		currTime++;
-	}
+/* Execute a delay in microseconds. Loop overhead makes it run slightly long, which is fine for minimum waits */
+void micro_delay(uint32_t micro)
+{
+	PROF_ENTER(PROF_DELAY);
+	while (micro--)
+		_delay_us(1);
+	PROF_EXIT(PROF_DELAY);
 }
 ///*
  //* timer.c
@@ -0,0 +1,165 @@
+/*
+ * watchdog.c
+ *
+ * Created: 10/19/2026 1:31:06 PM
+ *  Author: plete
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "watchdog.h"
+#include "timer.h"
+#include "atomic_access.h"
+#include "i2cMasterControl.h"
+#include <avr/io.h>
+#include <avr/wdt.h>
+
+#define RECORD_MAGIC			(0xA5C3)
+#define WDT_PERIOD_BITS			((1 << WDP2) | (1 << WDP1))	// ~1s time-out
+#define MAX_RESET_COUNT			(0xFF)
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+typedef struct wdg_record_s
+{
+	uint16_t magic;
+	wdg_reset_cause_t cause;
+} wdg_record_t;
+
+/* Survive a watchdog reset: .noinit is neither zeroed nor loaded by the startup code */
+static wdg_record_t resetRecord __attribute__((section(".noinit")));
+static uint8_t resetFlags __attribute__((section(".noinit")));
+
+static volatile uint32_t lastCheckIn[WDG_NUM_TASKS];
+static uint32_t deadlines[WDG_NUM_TASKS];		// 0 == task not supervised
+static void (*failSafeCB)(void);
+static wdg_reset_cause_t lastCause;
+static bool causeValid;
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+void wdtEarlyInit(void) __attribute__((naked, used, section(".init3")));
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+
+/**
+*	Load the reset cause left by a previous watchdog reset and start the watchdog in interrupt + reset mode.
+*	No task is supervised until watchdogEnableTask is called.
+*/
+void watchdogInit(void)
+{
+	if (resetRecord.magic != RECORD_MAGIC || (resetFlags & (1 << PORF)))
+	{
+		/* Power on (or corrupted record): nothing to report */
+		resetRecord.magic = RECORD_MAGIC;
+		resetRecord.cause.resetCount = 0;
+		causeValid = false;
+	}
+	else if (resetFlags & (1 << WDRF))
+	{
+		if (resetRecord.cause.resetCount < MAX_RESET_COUNT)
+			resetRecord.cause.resetCount++;
+		causeValid = true;
+	}
+	lastCause = resetRecord.cause;
+
+	/* Arm a fresh record. The ISR fills in the task if it catches the miss */
+	resetRecord.cause.task = WDG_UNKNOWN_TASK;
+	resetRecord.cause.i2cState = 0;
+	resetRecord.cause.i2cAddr = 0;
+	failSafeCB = NULL;
+	for (uint8_t i = 0; i < WDG_NUM_TASKS; i++)
+		deadlines[i] = 0;
+
+	ENTER_CRITICAL(W);
+	wdt_reset();
+	WDTCSR = (1 << WDCE) | (1 << WDE);
+	WDTCSR = (1 << WDIE) | (1 << WDE) | WDT_PERIOD_BITS;
+	EXIT_CRITICAL(W);
+}
+
+/* Start supervising a task. It must check in at least once every deadlineMs */
+void watchdogEnableTask(const wdg_task_t task, const uint32_t deadlineMs)
+{
+	uint32_t now = getMillis();
+	ENTER_CRITICAL(E);
+	lastCheckIn[task] = now;
+	deadlines[task] = deadlineMs;
+	EXIT_CRITICAL(E);
+}
+
+/* Stop supervising a task */
+void watchdogDisableTask(const wdg_task_t task)
+{
+	ENTER_CRITICAL(D);
+	deadlines[task] = 0;
+	EXIT_CRITICAL(D);
+}
+
+/* Report that a task is alive */
+void watchdogCheckIn(const wdg_task_t task)
+{
+	atomicWrite32(&lastCheckIn[task], getMillis());
+}
+
+/* Function run from the WDT ISR right before a reset is let through (e.g. drive the relay off) */
+void watchdogSetFailSafeCB(void (*funcP)(void))
+{
+	ENTER_CRITICAL(F);
+	failSafeCB = funcP;
+	EXIT_CRITICAL(F);
+}
+
+/* Retrieve why the last reset happened. Returns false if the last reset was not caused by the watchdog */
+bool watchdogGetResetCause(wdg_reset_cause_t *causeP)
+{
+	if (!causeValid)
+		return false;
+
+	*causeP = lastCause;
+	return true;
+}
+
+/* Called from WDT_vect once per watchdog period */
+void watchdogIsr(void)
+{
+	uint32_t now = getMillis();
+
+	for (uint8_t i = 0; i < WDG_NUM_TASKS; i++)
+	{
+		if (deadlines[i] && now - lastCheckIn[i] > deadlines[i])
+		{
+			resetRecord.cause.task = i;
+			resetRecord.cause.i2cState = i2cMasterGetState(&resetRecord.cause.i2cAddr);
+			if (failSafeCB != NULL)
+				failSafeCB();
+
+			/* WDIE was cleared by hardware: the next time-out resets the MCU */
+			return;
+		}
+	}
+
+	/* Everyone checked in: stay in interrupt mode for another period */
+	wdt_reset();
+	WDTCSR |= (1 << WDIE);
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+/**
+*	Runs before main and before .data/.bss are set up. After a watchdog reset the watchdog stays enabled at its
+*	shortest period, so it must be turned off before the slow init code gets a chance to run.
+*/
+void wdtEarlyInit(void)
+{
+	resetFlags = MCUSR;
+	MCUSR = 0;
+	wdt_disable();
+}
@@ -0,0 +1,54 @@
+/*
+ * host_test.h
+ *
+ * Created: 10/20/2026 9:02:11 AM
+ *  Author: plete
+ *
+ * Minimal check macros shared by the host tests. A failed check prints where and carries on so one run
+ * shows every failure; hostTestDone reports the totals and gives the process exit code.
+ */
+
+
+#ifndef HOST_TEST_H_
+#define HOST_TEST_H_
+
+/************************************************************************/
+/*							Includes/Constants	 	                    */
+/************************************************************************/
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static unsigned long hostChecks;
+static unsigned long hostFailures;
+
+#define CHECK(cond)		do { hostChecks++; if (!(cond)) { hostFailures++; \
+							if (hostFailures <= 20) printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); } } while (0)
+
+/************************************************************************/
+/*							Public Interfaces    	                    */
+/************************************************************************/
+
+/**
+*	Let another thread run here about one call in four, as if an interrupt fired at this point. Threads on a
+*	single core otherwise only switch on the scheduler tick and would rarely meet mid-operation.
+*/
+static inline void hostPreempt(void)
+{
+	static __thread uint32_t state = 2463534242UL;
+
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	if ((state & 3) == 0)
+		sched_yield();
+}
+
+/* Print the totals. Returns the exit code for main */
+static inline int hostTestDone(const char *nameP)
+{
+	printf("%s: %lu checks, %lu failed\n", nameP, hostChecks, hostFailures);
+	return hostFailures != 0;
+}
+
+#endif /* HOST_TEST_H_ */
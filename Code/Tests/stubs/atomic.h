@@ -0,0 +1,29 @@
+/*
+ * atomic.h
+ *
+ * Created: 10/20/2026 9:05:37 AM
+ *  Author: plete
+ *
+ * Host stand-in for utils/atomic.h. "Interrupts masked" becomes holding hostIrqLock, and a test thread playing
+ * an ISR holds the same lock for its whole body, so main side critical sections and ISR bodies exclude each
+ * other the same way they do on the AVR. Recursive, like nested ENTER/EXIT_CRITICAL pairs.
+ */
+
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+#include <pthread.h>
+
+extern pthread_mutex_t hostIrqLock;
+
+#define ENTER_CRITICAL(UNUSED)	pthread_mutex_lock(&hostIrqLock)
+#define EXIT_CRITICAL(UNUSED)	pthread_mutex_unlock(&hostIrqLock)
+
+#define DISABLE_INTERRUPTS()	pthread_mutex_lock(&hostIrqLock)
+#define ENABLE_INTERRUPTS()		pthread_mutex_unlock(&hostIrqLock)
+
+/* Define once in the test that uses it */
+#define HOST_IRQ_LOCK_DEFINE()	pthread_mutex_t hostIrqLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP
+
+#endif /* ATOMIC_H */
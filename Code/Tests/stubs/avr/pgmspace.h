@@ -0,0 +1,22 @@
+/*
+ * pgmspace.h
+ *
+ * Created: 10/20/2026 4:12:18 PM
+ *  Author: plete
+ *
+ * Host stand-in for avr/pgmspace.h. There is only one address space here, so flash tables are plain const
+ * data and the pgm_read_* accessors are ordinary loads.
+ */
+
+
+#ifndef PGMSPACE_H
+#define PGMSPACE_H
+
+#include <stdint.h>
+
+#define PROGMEM
+
+#define pgm_read_byte(addr)		(*(const uint8_t *)(addr))
+#define pgm_read_word(addr)		(*(const uint16_t *)(addr))
+
+#endif /* PGMSPACE_H */
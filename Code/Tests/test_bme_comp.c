@@ -0,0 +1,289 @@
+/*
+ * test_bme_comp.c
+ *
+ * Created: 10/20/2026 3:05:52 PM
+ *  Author: plete
+ *
+ * bmeCompensate against the unmodified vendor driver built three times (float, 64-bit and 32-bit integer, see
+ * the Makefile). Calibration coefficients are spread around the datasheet example values, wider than real parts
+ * for dig_p2 so the -40C overflow of the vendor 32-bit pressure path is hit. Each case picks a temperature,
+ * pressure and humidity and inverts them to raw ADC counts through the float formula.
+ * Temperature and humidity must match the 64-bit path exactly (same integer formulas), pressure must stay
+ * within PRESSURE_TOL_PA of the float result, which the vendor 32-bit path misses on the overflowing cases.
+ * Also times every variant over the same cases. Those are host cycles: int64 and double are native here, on AVR
+ * they are libgcc calls, so only the ranking carries over.
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "host_test.h"
+#include "bme_comp.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define NUM_CASES			(200000UL)
+#define TIMING_PASSES		(5)
+#define PRESSURE_TOL_PA		(8.0)		// The datasheet 32-bit formula itself is off by up to 7 Pa
+#define TEMP_TOL_C			(0.016)		// Integer formula, as the 64-bit path
+#define HUMIDITY_TOL_RH		(0.01)		// Integer formula, as the 64-bit path
+
+/* The driver's bme280_data in a BME280_FLOAT_ENABLE build */
+typedef struct float_data_s
+{
+	double pressure;
+	double temperature;
+	double humidity;
+} float_data_t;
+
+typedef struct comp_case_s
+{
+	struct bme280_calib_data calib;
+	struct bme280_uncomp_data uncomp;
+	float_data_t ref;
+} comp_case_t;
+
+typedef struct err_stats_s
+{
+	double tempC;
+	double pressurePa;
+	double humidityRh;
+} err_stats_t;
+
+int8_t bme280_compensate_FLOAT(uint8_t sensor_comp, const struct bme280_uncomp_data *uncomp_data,
+							   float_data_t *comp_data, struct bme280_calib_data *calib_data);
+int8_t bme280_compensate_64BIT(uint8_t sensor_comp, const struct bme280_uncomp_data *uncomp_data,
+							   struct bme280_data *comp_data, struct bme280_calib_data *calib_data);
+int8_t bme280_compensate_32BIT(uint8_t sensor_comp, const struct bme280_uncomp_data *uncomp_data,
+							   struct bme280_data *comp_data, struct bme280_calib_data *calib_data);
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+static comp_case_t cases[NUM_CASES];
+static uint64_t rngState = 88172645463325252ULL;
+static volatile uint32_t sink;
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+static void makeCases(void);
+static bool makeCase(comp_case_t *caseP);
+static void testAccuracy(void);
+static void noteError(err_stats_t *statsP, const double tempC, const double pressurePa, const double humidityRh,
+					  const float_data_t *refP);
+static void testTiming(void);
+static uint64_t now(void);
+static uint32_t rnd(void);
+static int32_t around(const int32_t typical, const int32_t spread);
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+int main(void)
+{
+	makeCases();
+	testAccuracy();
+	testTiming();
+
+	return hostTestDone("bme_comp");
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+static void makeCases(void)
+{
+	for (uint32_t i = 0; i < NUM_CASES; )
+	{
+		if (makeCase(&cases[i]))
+			i++;
+	}
+}
+
+/* Random coefficients and conditions, inverted to raw counts by bisection. False if out of the sensor range */
+static bool makeCase(comp_case_t *caseP)
+{
+	struct bme280_calib_data *c = &caseP->calib;
+	struct bme280_uncomp_data *u = &caseP->uncomp;
+	float_data_t d;
+	uint32_t lo, hi;
+
+	c->dig_t1 = around(27504, 6000);	c->dig_t2 = around(26435, 6000);	c->dig_t3 = around(-1000, 1000);
+	c->dig_p1 = around(36477, 6000);	c->dig_p2 = around(-10685, 8000);	c->dig_p3 = around(3024, 1000);
+	c->dig_p4 = around(2855, 2000);		c->dig_p5 = around(140, 140);		c->dig_p6 = around(-7, 7);
+	c->dig_p7 = around(15500, 3000);	c->dig_p8 = around(-14600, 3000);	c->dig_p9 = around(6000, 2000);
+	c->dig_h1 = around(75, 75);			c->dig_h2 = around(362, 60);		c->dig_h3 = 0;
+	c->dig_h4 = around(313, 60);		c->dig_h5 = around(50, 50);			c->dig_h6 = around(30, 30);
+
+	double tempC = -40.0 + 125.0 * rnd() / 4294967296.0;
+	double pressurePa = 30000.0 + 80000.0 * rnd() / 4294967296.0;
+	double humidityRh = 1.0 + 98.0 * rnd() / 4294967296.0;
+
+	/* Temperature rises with its count, pressure falls with its count, humidity rises */
+	u->pressure = 0x80000;
+	u->humidity = 0x8000;
+	for (lo = 0, hi = 0xFFFFF; lo < hi; )
+	{
+		u->temperature = (lo + hi) / 2;
+		bme280_compensate_FLOAT(BME280_TEMP, u, &d, c);
+		if (d.temperature < tempC)
+			lo = u->temperature + 1;
+		else
+			hi = u->temperature;
+	}
+	u->temperature = lo;
+	for (lo = 0, hi = 0xFFFFF; lo < hi; )
+	{
+		u->pressure = (lo + hi) / 2;
+		bme280_compensate_FLOAT(BME280_ALL, u, &d, c);
+		if (d.pressure > pressurePa)
+			lo = u->pressure + 1;
+		else
+			hi = u->pressure;
+	}
+	u->pressure = lo;
+	for (lo = 0, hi = 0xFFFF; lo < hi; )
+	{
+		u->humidity = (lo + hi) / 2;
+		bme280_compensate_FLOAT(BME280_ALL, u, &d, c);
+		if (d.humidity < humidityRh)
+			lo = u->humidity + 1;
+		else
+			hi = u->humidity;
+	}
+	u->humidity = lo;
+
+	bme280_compensate_FLOAT(BME280_ALL, u, &caseP->ref, c);
+	return caseP->ref.temperature > -40.0 && caseP->ref.temperature < 85.0 &&
+		   caseP->ref.pressure > 30000.0 && caseP->ref.pressure < 110000.0 &&
+		   caseP->ref.humidity > 0.0 && caseP->ref.humidity < 100.0;
+}
+
+static void testAccuracy(void)
+{
+	err_stats_t errComp = { 0 }, err64 = { 0 }, err32 = { 0 };
+	struct bme280_data comp, v64, v32;
+	uint32_t overflows = 0;
+	long maxScalingPa = 0;
+
+	for (uint32_t i = 0; i < NUM_CASES; i++)
+	{
+		comp_case_t *caseP = &cases[i];
+
+		bmeCompensate(&caseP->uncomp, &caseP->calib, &comp);
+		bme280_compensate_64BIT(BME280_ALL, &caseP->uncomp, &v64, &caseP->calib);
+		bme280_compensate_32BIT(BME280_ALL, &caseP->uncomp, &v32, &caseP->calib);
+
+		CHECK(comp.temperature == v64.temperature);
+		CHECK(comp.humidity == v64.humidity);
+		CHECK(fabs(comp.pressure - caseP->ref.pressure) <= PRESSURE_TOL_PA);
+		CHECK(fabs(comp.temperature / 100.0 - caseP->ref.temperature) <= TEMP_TOL_C);
+		CHECK(fabs(comp.humidity / 1024.0 - caseP->ref.humidity) <= HUMIDITY_TOL_RH);
+		if (fabs(v32.pressure - caseP->ref.pressure) > PRESSURE_TOL_PA)
+			overflows++;
+		else if (labs((long)comp.pressure - (long)v32.pressure) > maxScalingPa)
+			maxScalingPa = labs((long)comp.pressure - (long)v32.pressure);
+
+		noteError(&errComp, comp.temperature / 100.0, comp.pressure, comp.humidity / 1024.0, &caseP->ref);
+		noteError(&err64, v64.temperature / 100.0, v64.pressure / 100.0, v64.humidity / 1024.0, &caseP->ref);
+		noteError(&err32, v32.temperature / 100.0, v32.pressure, v32.humidity / 1024.0, &caseP->ref);
+	}
+
+	printf("max error vs float over %lu cases    C       Pa      %%RH\n", NUM_CASES);
+	printf("  bmeCompensate                  %7.4f %8.2f %7.4f\n", errComp.tempC, errComp.pressurePa, errComp.humidityRh);
+	printf("  vendor 64-bit                  %7.4f %8.2f %7.4f\n", err64.tempC, err64.pressurePa, err64.humidityRh);
+	printf("  vendor 32-bit                  %7.4f %8.2f %7.4f  (%lu cases out of tolerance)\n",
+		   err32.tempC, err32.pressurePa, err32.humidityRh, (unsigned long)overflows);
+	printf("  bmeCompensate - vendor 32-bit where that is in tolerance: max %ld Pa\n", maxScalingPa);
+	CHECK(overflows != 0);		// Or the coefficient spread no longer covers the case bmeCompensate fixes
+}
+
+static void noteError(err_stats_t *statsP, const double tempC, const double pressurePa, const double humidityRh,
+					  const float_data_t *refP)
+{
+	statsP->tempC = fmax(statsP->tempC, fabs(tempC - refP->temperature));
+	statsP->pressurePa = fmax(statsP->pressurePa, fabs(pressurePa - refP->pressure));
+	statsP->humidityRh = fmax(statsP->humidityRh, fabs(humidityRh - refP->humidity));
+}
+
+/* Best of TIMING_PASSES runs over every case, per call */
+static void testTiming(void)
+{
+	uint64_t best[4] = { UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX };
+	static const char *const names[4] = { "float", "vendor 64-bit", "vendor 32-bit", "bmeCompensate" };
+	struct bme280_data data;
+	float_data_t fdata;
+
+	for (uint8_t pass = 0; pass < TIMING_PASSES; pass++)
+	{
+		for (uint8_t variant = 0; variant < 4; variant++)
+		{
+			uint64_t start = now();
+			for (uint32_t i = 0; i < NUM_CASES; i++)
+			{
+				comp_case_t *caseP = &cases[i];
+				switch (variant)
+				{
+					case 0:
+						bme280_compensate_FLOAT(BME280_ALL, &caseP->uncomp, &fdata, &caseP->calib);
+						sink += (uint32_t)fdata.pressure;
+						break;
+					case 1:
+						bme280_compensate_64BIT(BME280_ALL, &caseP->uncomp, &data, &caseP->calib);
+						sink += data.pressure;
+						break;
+					case 2:
+						bme280_compensate_32BIT(BME280_ALL, &caseP->uncomp, &data, &caseP->calib);
+						sink += data.pressure;
+						break;
+					default:
+						bmeCompensate(&caseP->uncomp, &caseP->calib, &data);
+						sink += data.pressure;
+						break;
+				}
+			}
+			uint64_t elapsed = now() - start;
+			if (elapsed < best[variant])
+				best[variant] = elapsed;
+		}
+	}
+
+#if defined(__x86_64__) || defined(__i386__)
+	printf("host TSC cycles per reading (all three channels):\n");
+#else
+	printf("host ns per reading (all three channels):\n");
+#endif
+	for (uint8_t variant = 0; variant < 4; variant++)
+		printf("  %-14s %6.1f\n", names[variant], (double)best[variant] / NUM_CASES);
+}
+
+static uint64_t now(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static uint32_t rnd(void)
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 7;
+	rngState ^= rngState << 17;
+	return (uint32_t)rngState;
+}
+
+static int32_t around(const int32_t typical, const int32_t spread)
+{
+	return typical - spread + (int32_t)(rnd() % (2 * (uint32_t)spread + 1));
+}
@@ -0,0 +1,194 @@
+/*
+ * test_climate.c
+ *
+ * Created: 10/20/2026 4:20:05 PM
+ *  Author: plete
+ *
+ * climate.c against double precision Magnus (the formula its table was made from), on a grid of T every 0.07C
+ * over the table range and RH every 0.25% from 1 to 100%, 453k cases. The bounds are the worst cases measured
+ * when the module went in, rounded up, over the full range and over 0..45C where the plants live.
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "host_test.h"
+#include "climate.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define T_STEP_C100			(7)
+#define RH_STEP_100			(25)
+#define GROWING_MIN_C100	(0)
+#define GROWING_MAX_C100	(4500)
+
+/************************************************************************/
+/*				Type Defs + Struct Declaration							*/
+/************************************************************************/
+typedef struct err_bounds_s
+{
+	double svpPa;
+	double svpRel;
+	double vpdPa;
+	double dewPointC;
+	double absHumidity;
+} err_bounds_t;
+
+/* Full table range, then 0..45C */
+static const err_bounds_t fullBounds = { 5.2, 0.0055, 5.5, 0.12, 0.045 };
+static const err_bounds_t growingBounds = { 2.9, 0.0017, 3.4, 0.09, 0.035 };
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+static double magnusSvp(const double tempC);
+static double magnusDewPoint(const double vapourPa);
+static void testGrid(void);
+static void checkBounds(const char *nameP, const err_bounds_t *maxP, const err_bounds_t *boundsP, const long cases);
+static void testTable(void);
+static void testAverage(void);
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+int main(void)
+{
+	testTable();
+	testGrid();
+	testAverage();
+
+	return hostTestDone("climate");
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+static double magnusSvp(const double tempC)
+{
+	return 610.94 * exp(17.625 * tempC / (tempC + 243.04));
+}
+
+static double magnusDewPoint(const double vapourPa)
+{
+	double l = log(vapourPa / 610.94);
+	return 243.04 * l / (17.625 - l);
+}
+
+/* Every metric of every grid point, worst case per range */
+static void testGrid(void)
+{
+	err_bounds_t full = { 0 }, growing = { 0 };
+	long fullCases = 0, growingCases = 0;
+
+	for (int16_t t = CLIMATE_MIN_C * 100; t <= CLIMATE_MAX_C * 100; t += T_STEP_C100)
+	{
+		for (uint16_t rh = 100; rh <= 10000; rh += RH_STEP_100)
+		{
+			climate_t climate;
+			climateReset(&climate);
+			climateUpdate(&climate, t, rh);
+
+			double tempC = t / 100.0;
+			double svp = magnusSvp(tempC);
+			double vapour = svp * rh / 10000.0;
+			double dewPoint = magnusDewPoint(vapour);
+			double absHumidity = 2.1674 * vapour / (tempC + 273.15);
+
+			err_bounds_t err;
+			err.svpPa = fabs(climate.svpPa - svp);
+			err.svpRel = err.svpPa / svp;
+			err.vpdPa = fabs(climate.vpdPa - (svp - vapour));
+			err.dewPointC = dewPoint < CLIMATE_MIN_C ? 0.0 : fabs(climate.dewPointC100 / 100.0 - dewPoint);
+			err.absHumidity = fabs(climate.absHumidity100 / 100.0 - absHumidity);
+
+			/* Below the table the dew point clamps instead */
+			if (dewPoint < CLIMATE_MIN_C)
+				CHECK(climate.dewPointC100 == CLIMATE_MIN_C * 100);
+
+			err_bounds_t *rangeP[2] = { &full, t >= GROWING_MIN_C100 && t <= GROWING_MAX_C100 ? &growing : NULL };
+			for (uint8_t r = 0; r < 2; r++)
+			{
+				if (rangeP[r] == NULL)
+					continue;
+				rangeP[r]->svpPa = fmax(rangeP[r]->svpPa, err.svpPa);
+				rangeP[r]->svpRel = fmax(rangeP[r]->svpRel, err.svpRel);
+				rangeP[r]->vpdPa = fmax(rangeP[r]->vpdPa, err.vpdPa);
+				rangeP[r]->dewPointC = fmax(rangeP[r]->dewPointC, err.dewPointC);
+				rangeP[r]->absHumidity = fmax(rangeP[r]->absHumidity, err.absHumidity);
+			}
+			fullCases++;
+			if (rangeP[1] != NULL)
+				growingCases++;
+		}
+	}
+
+	checkBounds("-20..60C", &full, &fullBounds, fullCases);
+	checkBounds("0..45C", &growing, &growingBounds, growingCases);
+}
+
+static void checkBounds(const char *nameP, const err_bounds_t *maxP, const err_bounds_t *boundsP, const long cases)
+{
+	printf("%-8s %6ld cases: SVP %.2f Pa (%.2f%%) | VPD %.2f Pa | dew point %.3f C | AH %.3f g/m3\n", nameP, cases,
+		   maxP->svpPa, 100.0 * maxP->svpRel, maxP->vpdPa, maxP->dewPointC, maxP->absHumidity);
+	CHECK(maxP->svpPa <= boundsP->svpPa);
+	CHECK(maxP->svpRel <= boundsP->svpRel);
+	CHECK(maxP->vpdPa <= boundsP->vpdPa);
+	CHECK(maxP->dewPointC <= boundsP->dewPointC);
+	CHECK(maxP->absHumidity <= boundsP->absHumidity);
+}
+
+/* Whole degrees hit the table exactly, both lookups are monotonic and clamp outside the table */
+static void testTable(void)
+{
+	for (int16_t c = CLIMATE_MIN_C; c <= CLIMATE_MAX_C; c++)
+	{
+		uint16_t svp = climateSvp(c * 100);
+		CHECK(svp == (uint16_t)lround(magnusSvp(c)));
+		CHECK(climateDewPoint(svp) == c * 100);
+	}
+
+	uint16_t lastSvp = 0;
+	for (int16_t t = CLIMATE_MIN_C * 100; t <= CLIMATE_MAX_C * 100; t++)
+	{
+		uint16_t svp = climateSvp(t);
+		CHECK(svp >= lastSvp);
+		lastSvp = svp;
+	}
+	int16_t lastDewPoint = CLIMATE_MIN_C * 100;
+	for (uint32_t e = 0; e <= 0xFFFF; e++)
+	{
+		int16_t dewPoint = climateDewPoint((uint16_t)e);
+		CHECK(dewPoint >= lastDewPoint && dewPoint <= CLIMATE_MAX_C * 100);
+		lastDewPoint = dewPoint;
+	}
+
+	CHECK(climateSvp(-4000) == climateSvp(CLIMATE_MIN_C * 100));
+	CHECK(climateSvp(8500) == climateSvp(CLIMATE_MAX_C * 100));
+}
+
+/* The running average starts at the first sample and covers 1/8 of the remaining distance per sample */
+static void testAverage(void)
+{
+	climate_t climate;
+	climateReset(&climate);
+
+	climateUpdate(&climate, 2500, 6000);
+	uint16_t humidVpd = climate.vpdPa;
+	CHECK(climateVpdAverage(&climate) == humidVpd);
+	for (uint8_t i = 0; i < 40; i++)
+		climateUpdate(&climate, 2500, 6000);
+	CHECK(climateVpdAverage(&climate) == humidVpd);
+
+	climateUpdate(&climate, 2500, 4000);
+	uint16_t dryVpd = climate.vpdPa;
+	double expect = humidVpd;
+	for (uint8_t i = 0; i < 80; i++)
+	{
+		expect += (dryVpd - expect) / 8.0;
+		CHECK(fabs(climateVpdAverage(&climate) - expect) <= 1.0);
+		climateUpdate(&climate, 2500, 4000);
+	}
+	CHECK(abs(climateVpdAverage(&climate) - dryVpd) <= 1);
+	CHECK(climate.samples == 122);
+}
@@ -0,0 +1,188 @@
+/*
+ * test_epoch.c
+ *
+ * Created: 10/20/2026 10:02:37 AM
+ *  Author: plete
+ *
+ * epoch.c against the C library's own calendar (timegm/gmtime_r, UTC so no DST).
+ * Date and time of day are converted independently, so the round trip is covered by every day 2000-2099 at
+ * every minute (the second rotating with the day), plus every second of the days where the tables change.
+ * Every month/date register combination, valid or not, is checked for acceptance against the library.
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "host_test.h"
+#include "epoch.h"
+#include <string.h>
+#include <time.h>
+
+#define DAYS_2000_2099		(36525UL)
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+static time_t base2000;
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+static void testBcdBytes(void);
+static void testRoundTrip(void);
+static void checkSecond(const epoch_t t, const struct tm *dayP);
+static void testWholeDays(void);
+static void testRegisterRanges(void);
+static void expectedRegs(const struct tm *tmP, uint8_t time[TIME_UNITS_TOTAL]);
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+int main(void)
+{
+	struct tm start = { .tm_year = 100, .tm_mday = 1 };
+	base2000 = timegm(&start);
+
+	testBcdBytes();
+	testRoundTrip();
+	testWholeDays();
+	testRegisterRanges();
+
+	CHECK(epochDiff(epochAdd(1000, -1500), 1000) == -1500);
+	CHECK(epochDiff(epochAdd(EPOCH_MAX_BCD, EPOCH_SECS_PER_WEEK), EPOCH_MAX_BCD) == (int32_t)EPOCH_SECS_PER_WEEK);
+
+	return hostTestDone("epoch");
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+/* All 100 byte values both ways */
+static void testBcdBytes(void)
+{
+	for (uint8_t v = 0; v < 100; v++)
+	{
+		uint8_t bcd = (uint8_t)(((v / 10) << 4) | (v % 10));
+		CHECK(epochBinToBcd(v) == bcd);
+		CHECK(epochBcdToBin(bcd) == v);
+	}
+}
+
+/* Every day of 2000-2099 at every minute, with a different second each day */
+static void testRoundTrip(void)
+{
+	for (uint32_t day = 0; day < DAYS_2000_2099; day++)
+	{
+		time_t tt = base2000 + (time_t)day * EPOCH_SECS_PER_DAY;
+		struct tm date;
+		gmtime_r(&tt, &date);
+
+		for (uint32_t minute = 0; minute < 24 * 60; minute++)
+			checkSecond(day * EPOCH_SECS_PER_DAY + minute * EPOCH_SECS_PER_MIN + (day + minute) % 60, &date);
+	}
+}
+
+/* One second both ways. dayP is midnight of the same day, from the library */
+static void checkSecond(const epoch_t t, const struct tm *dayP)
+{
+	uint8_t regs[TIME_UNITS_TOTAL], expect[TIME_UNITS_TOTAL];
+	struct tm tmv = *dayP;
+	uint32_t secOfDay = t % EPOCH_SECS_PER_DAY;
+	epoch_t back = 0;
+
+	tmv.tm_hour = secOfDay / 3600;
+	tmv.tm_min = secOfDay / 60 % 60;
+	tmv.tm_sec = secOfDay % 60;
+	expectedRegs(&tmv, expect);
+
+	epochToBcd(t, regs);
+	CHECK(memcmp(regs, expect, sizeof(regs)) == 0);
+	CHECK(epochDayOfWeek(t) == expect[TIME_UNITS_DY]);
+	CHECK(epochFromBcd(regs, &back) && back == t);
+}
+
+/* Every second of the first day, a leap day, the day after it, a non leap 28 Feb and the last day */
+static void testWholeDays(void)
+{
+	static const uint32_t days[] = { 0, 59, 60, 365 + 58, 366 + 365 + 365 + 365 + 59, DAYS_2000_2099 - 1 };
+
+	for (uint8_t i = 0; i < sizeof(days) / sizeof(days[0]); i++)
+	{
+		time_t tt = base2000 + (time_t)days[i] * EPOCH_SECS_PER_DAY;
+		struct tm date;
+		gmtime_r(&tt, &date);
+
+		for (uint32_t s = 0; s < EPOCH_SECS_PER_DAY; s++)
+			checkSecond(days[i] * EPOCH_SECS_PER_DAY + s, &date);
+	}
+	CHECK((days[5] + 1) * EPOCH_SECS_PER_DAY - 1 == EPOCH_MAX_BCD);
+}
+
+/**
+*	Every month register value against every date register value in 2000 (leap), 2001 and 2099: accepted exactly
+*	when the library keeps the date as is. Then the out of range time fields.
+*/
+static void testRegisterRanges(void)
+{
+	static const uint8_t years[] = { 0, 1, 99 };
+	uint8_t regs[TIME_UNITS_TOTAL];
+	epoch_t t;
+
+	for (uint8_t y = 0; y < sizeof(years) / sizeof(years[0]); y++)
+	{
+		for (uint16_t monthReg = 0; monthReg < 0x100; monthReg++)
+		{
+			for (uint16_t dateReg = 0; dateReg < 0x100; dateReg++)
+			{
+				memset(regs, 0, sizeof(regs));
+				regs[TIME_UNITS_YR] = epochBinToBcd(years[y]);
+				regs[TIME_UNITS_MO_CEN] = (uint8_t)monthReg;
+				regs[TIME_UNITS_DT] = (uint8_t)dateReg;
+				regs[TIME_UNITS_DY] = MON;
+
+				/* Only 5 bits of BCD month count, the bits above (century and the two unused ones) are ignored */
+				uint8_t month = (monthReg & 0x1F) >> 4 ? 10 + (monthReg & 0x0F) : (monthReg & 0x0F);
+				bool validBcd = (monthReg & 0x0F) <= 9 && (dateReg & 0x0F) <= 9;
+				int date = (dateReg >> 4) * 10 + (dateReg & 0x0F);
+
+				bool expectOk = false;
+				if (validBcd && month >= 1 && month <= 12 && date >= 1)
+				{
+					struct tm tmv = { .tm_year = 100 + years[y], .tm_mon = month - 1, .tm_mday = date };
+					timegm(&tmv);
+					expectOk = tmv.tm_mday == date && tmv.tm_mon == month - 1;
+				}
+				CHECK(epochFromBcd(regs, &t) == expectOk);
+			}
+		}
+	}
+
+	/* 2004-02-29 23:59:59 is fine, one more in any time field is not */
+	static const uint8_t good[TIME_UNITS_TOTAL] = { 0x59, 0x59, 0x23, SUN, 0x29, 0x02, 0x04 };
+	CHECK(epochFromBcd(good, &t));
+	for (uint8_t unit = TIME_UNITS_SEC; unit <= TIME_UNITS_HR; unit++)
+	{
+		memcpy(regs, good, sizeof(regs));
+		regs[unit] = unit == TIME_UNITS_HR ? 0x24 : 0x60;
+		t = 1234;
+		CHECK(!epochFromBcd(regs, &t) && t == 1234);
+		regs[unit] = good[unit] + 1;		// 0x5A / 0x24: not BCD or out of range
+		CHECK(!epochFromBcd(regs, &t));
+	}
+	memcpy(regs, good, sizeof(regs));
+	regs[TIME_UNITS_YR] = 0xA0;
+	CHECK(!epochFromBcd(regs, &t));
+}
+
+/* Registers the DS3231 would hold for a library broken down time */
+static void expectedRegs(const struct tm *tmP, uint8_t time[TIME_UNITS_TOTAL])
+{
+	time[TIME_UNITS_SEC] = epochBinToBcd(tmP->tm_sec);
+	time[TIME_UNITS_MIN] = epochBinToBcd(tmP->tm_min);
+	time[TIME_UNITS_HR] = epochBinToBcd(tmP->tm_hour);
+	time[TIME_UNITS_DY] = tmP->tm_wday == 0 ? SUN : tmP->tm_wday;
+	time[TIME_UNITS_DT] = epochBinToBcd(tmP->tm_mday);
+	time[TIME_UNITS_MO_CEN] = epochBinToBcd(tmP->tm_mon + 1);
+	time[TIME_UNITS_YR] = epochBinToBcd(tmP->tm_year - 100);
+}
@@ -0,0 +1,178 @@
+/*
+ * test_filter.c
+ *
+ * Created: 10/20/2026 5:02:44 PM
+ *  Author: plete
+ *
+ * filter.c stage by stage: the sorted window against a brute-force median of the last readings over 100k random
+ * values, the EMA against the same average in double, the outlier rejection and restart rules, and the C x100
+ * spike trace the module was tuned on.
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "host_test.h"
+#include "filter.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_RANDOM			(100000UL)
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+static uint32_t rngState = 2463534242UL;
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+static void testMedian(void);
+static int16_t bruteMedian(const int16_t *lastP, const uint8_t count);
+static int compareInt16(const void *aP, const void *bP);
+static void testEma(void);
+static void testRejection(void);
+static void testSpikeTrace(void);
+static uint32_t rnd(void);
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+int main(void)
+{
+	testMedian();
+	testEma();
+	testRejection();
+	testSpikeTrace();
+
+	return hostTestDone("filter");
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+/* Shift 0 and no rejection pass the median straight out. Narrow ranges so duplicates get exercised too */
+static void testMedian(void)
+{
+	static const uint16_t spans[] = { 4, 2000, 65535 };
+
+	for (uint8_t s = 0; s < sizeof(spans) / sizeof(spans[0]); s++)
+	{
+		int16_t last[FILTER_MEDIAN_SIZE];
+		filter_t filter;
+
+		filterInit(&filter, 0, 0);
+		CHECK(!filterIsValid(&filter));
+		for (uint32_t i = 0; i < NUM_RANDOM; i++)
+		{
+			int16_t value = (int16_t)(rnd() % (spans[s] + 1UL) - spans[s] / 2);
+			last[i % FILTER_MEDIAN_SIZE] = value;
+
+			uint8_t count = i < FILTER_MEDIAN_SIZE ? (uint8_t)(i + 1) : FILTER_MEDIAN_SIZE;
+			CHECK(filterUpdate(&filter, value) == bruteMedian(last, count));
+			CHECK(filterIsValid(&filter) && filter.count == count);
+		}
+	}
+}
+
+/* Middle of the count readings in last (upper middle for an even count, as the window does while filling) */
+static int16_t bruteMedian(const int16_t *lastP, const uint8_t count)
+{
+	int16_t sorted[FILTER_MEDIAN_SIZE];
+
+	memcpy(sorted, lastP, count * sizeof(sorted[0]));
+	qsort(sorted, count, sizeof(sorted[0]), compareInt16);
+	return sorted[count / 2];
+}
+
+static int compareInt16(const void *aP, const void *bP)
+{
+	return *(const int16_t *)aP - *(const int16_t *)bP;
+}
+
+/* A constant input comes out unchanged, and a step follows the 1/2^shift average within rounding */
+static void testEma(void)
+{
+	for (uint8_t shift = 1; shift <= 4; shift++)
+	{
+		filter_t filter;
+		filterInit(&filter, shift, 0);
+
+		for (uint8_t i = 0; i < 10; i++)
+			CHECK(filterUpdate(&filter, -1234) == -1234);
+
+		/* Once the window is full of the new level the median is the new level */
+		double expect = -1234.0;
+		for (uint8_t i = 0; i < 200; i++)
+		{
+			int16_t out = filterUpdate(&filter, 3000);
+			if (i >= FILTER_MEDIAN_SIZE / 2)
+				expect += (3000.0 - expect) / (1 << shift);
+			CHECK(fabs(out - expect) <= 1.0);
+		}
+		CHECK(filterGet(&filter) >= 2999 && filterGet(&filter) <= 3000);
+	}
+}
+
+/* FILTER_REJECT_LIMIT outliers in a row are dropped, the next one restarts the filter there. The count saturates */
+static void testRejection(void)
+{
+	filter_t filter;
+	filterInit(&filter, 1, 100);
+
+	CHECK(filterUpdate(&filter, 5000) == 5000);		// The first reading is never an outlier
+	CHECK(filterUpdate(&filter, 5100) == 5050);		// Exactly rejectBand away is kept
+
+	for (uint8_t i = 0; i < FILTER_REJECT_LIMIT; i++)
+		CHECK(filterUpdate(&filter, 9000) == 5050);
+	CHECK(filter.rejected == FILTER_REJECT_LIMIT);
+	CHECK(filterUpdate(&filter, 9000) == 9000);
+	CHECK(filter.count == 1);
+
+	/* A spike between good readings never builds a run */
+	for (uint32_t i = 0; i < 70000; i++)
+	{
+		CHECK(filterUpdate(&filter, -9000) == 9000);
+		filterUpdate(&filter, 9000);
+	}
+	CHECK(filter.rejected == 0xFFFF);
+
+	/* rejectBand 0 keeps everything */
+	filterInit(&filter, 0, 0);
+	filterUpdate(&filter, 0);
+	filterUpdate(&filter, 30000);
+	CHECK(filterUpdate(&filter, -30000) == 0 && filter.rejected == 0);
+}
+
+/* Temperature in C x100 with +4C and +6C spikes, a real +6C step and a -5 bus glitch. Band 2C, shift 1 */
+static void testSpikeTrace(void)
+{
+	static const int16_t in[] = { 2000, 2010, 2005, 2400, 2012, 2008, 1990, 2600, 2610, 2605, 2600, 2598, 2603, -5, 2601 };
+	static const int16_t out[] = { 2000, 2005, 2005, 2005, 2008, 2008, 2008, 2008, 2008, 2605, 2605, 2603, 2602, 2602, 2602 };
+	filter_t filter;
+
+	filterInit(&filter, 1, 200);
+	for (uint8_t i = 0; i < sizeof(in) / sizeof(in[0]); i++)
+	{
+		int16_t value = filterUpdate(&filter, in[i]);
+		CHECK(value == out[i]);
+
+		/* Spikes never take the output outside the good readings around them, the step gets through on its
+		   third reading */
+		if (i < 9)
+			CHECK(value >= 2000 && value <= 2010);
+		else
+			CHECK(value >= 2598 && value <= 2610);
+	}
+	CHECK(filter.rejected == 4);
+}
+
+static uint32_t rnd(void)
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
@@ -0,0 +1,385 @@
+/*
+ * test_ring_buffer.c
+ *
+ * Created: 10/20/2026 9:14:45 AM
+ *  Author: plete
+ *
+ * ring_buffer.h and atomic_access.h on the host.
+ * First every operation is checked against a plain array queue over long random sequences, for every capacity
+ * and a few element sizes, so the free running 8-bit indices wrap many times. Then a second thread plays the
+ * ISR: it produces into (or consumes from) a ring buffer while the main thread does the other side, and it
+ * updates multi-byte variables one byte at a time with the "interrupt" lock held while the main thread reads
+ * them through the atomic helpers. RING_BUFFER_BARRIER and the byte updates are turned into random preemption
+ * points, so the other side also runs right where an element is being published, released or half written.
+ * x86 keeps stores in order, so like on the AVR the compiler barrier is all the ring buffer needs.
+ */
+
+/************************************************************************/
+/*                     Includes/Constants                               */
+/************************************************************************/
+#include "host_test.h"
+
+#define RING_BUFFER_BARRIER()	hostPreempt()
+
+#include "ring_buffer.h"
+#include "atomic_access.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MODEL_OPS			(200000UL)
+#define STREAM_ELEMENTS		(500000UL)
+#define ISR_UPDATES			(500000UL)
+#define MAX_ELEM_SIZE		(8)
+
+HOST_IRQ_LOCK_DEFINE();
+
+/************************************************************************/
+/*                      Type Defs + Struct Declaration                  */
+/************************************************************************/
+
+/* Stream element: inv must always be ~seq, anything else is a torn copy */
+typedef struct stream_elem_s
+{
+	uint32_t seq;
+	uint32_t inv;
+} stream_elem_t;
+
+typedef struct stream_s
+{
+	ring_buffer_t rb;
+	stream_elem_t storage[RING_BUFFER_MAX_CAPACITY];
+	unsigned long errors;
+} stream_t;
+
+/************************************************************************/
+/*                      Private Variables                               */
+/************************************************************************/
+static volatile bool isrRun;
+static volatile uint32_t shared32;		// Every byte equal when not torn
+static volatile uint16_t shared16;
+static volatile uint8_t eventCount;
+static volatile bool eventFlag;
+static unsigned long eventsRaised;
+static unsigned long flagsRaised;
+
+/************************************************************************/
+/*                      Private Function Declaration                    */
+/************************************************************************/
+static void testAgainstModel(const uint8_t capacity, const uint8_t elemSize);
+static void testStream(const uint8_t capacity, const bool isrProduces);
+static void *streamProducer(void *argP);
+static void *streamConsumer(void *argP);
+static void testAtomicRead(void);
+static void *isrWriteBytes(void *argP);
+static void testAtomicWrite(void);
+static void *isrCheckBytes(void *argP);
+static void testFetchAndClear(void);
+static void *isrRaiseEvents(void *argP);
+static bool bytesEqual32(const uint32_t val);
+
+/************************************************************************/
+/*                      Public Functions Implementations                */
+/************************************************************************/
+int main(void)
+{
+	srand(26);
+
+	for (uint16_t capacity = 1; capacity <= RING_BUFFER_MAX_CAPACITY; capacity <<= 1)
+	{
+		testAgainstModel((uint8_t)capacity, 1);
+		testAgainstModel((uint8_t)capacity, 3);
+		testAgainstModel((uint8_t)capacity, MAX_ELEM_SIZE);
+	}
+
+	testStream(1, true);
+	testStream(4, true);
+	testStream(RING_BUFFER_MAX_CAPACITY, true);
+	testStream(1, false);
+	testStream(4, false);
+	testStream(RING_BUFFER_MAX_CAPACITY, false);
+
+	testAtomicRead();
+	testAtomicWrite();
+	testFetchAndClear();
+
+	return hostTestDone("ring_buffer/atomic_access");
+}
+
+/************************************************************************/
+/*                     Private Functions Implementation                 */
+/************************************************************************/
+
+/* Random push/pop/peek/flush mix checked step by step against an array queue */
+static void testAgainstModel(const uint8_t capacity, const uint8_t elemSize)
+{
+	uint8_t storage[RING_BUFFER_MAX_CAPACITY * MAX_ELEM_SIZE];
+	uint8_t model[RING_BUFFER_MAX_CAPACITY][MAX_ELEM_SIZE];
+	unsigned modelHead = 0, modelCount = 0;
+	uint8_t elem[MAX_ELEM_SIZE], out[MAX_ELEM_SIZE];
+	uint8_t fill = 0;
+	ring_buffer_t rb;
+
+	ringBufferInit(&rb, storage, elemSize, capacity);
+	CHECK(ringBufferIsEmpty(&rb));
+
+	for (unsigned long op = 0; op < MODEL_OPS; op++)
+	{
+		/* Lean towards pushing or popping in long stretches so both full and empty are hit often */
+		int r = rand() % 100;
+		bool pushBias = (op / 1000) % 2 == 0;
+
+		if (r < (pushBias ? 60 : 35))
+		{
+			for (uint8_t i = 0; i < elemSize; i++)
+				elem[i] = fill++;
+			bool ok = ringBufferPush(&rb, elem);
+			CHECK(ok == (modelCount < capacity));
+			if (ok)
+			{
+				memcpy(model[(modelHead + modelCount) % capacity], elem, elemSize);
+				modelCount++;
+			}
+		}
+		else if (r < 95)
+		{
+			bool peek = r < 45;
+			bool ok = peek ? ringBufferPeek(&rb, out) : ringBufferPop(&rb, out);
+			CHECK(ok == (modelCount != 0));
+			if (ok)
+			{
+				CHECK(memcmp(out, model[modelHead], elemSize) == 0);
+				if (!peek)
+				{
+					modelHead = (modelHead + 1) % capacity;
+					modelCount--;
+				}
+			}
+		}
+		else if (r == 99)
+		{
+			ringBufferFlush(&rb);
+			modelHead = (modelHead + modelCount) % capacity;
+			modelCount = 0;
+		}
+
+		CHECK(ringBufferCount(&rb) == modelCount);
+		CHECK(ringBufferIsEmpty(&rb) == (modelCount == 0));
+		CHECK(ringBufferIsFull(&rb) == (modelCount == capacity));
+	}
+}
+
+/**
+*	One thread pushes STREAM_ELEMENTS numbered elements, retrying while full, the other pops them and checks
+*	that every one arrives exactly once, in order and untorn. isrProduces picks which side the second thread is.
+*/
+static void testStream(const uint8_t capacity, const bool isrProduces)
+{
+	stream_t stream;
+	pthread_t isr;
+
+	memset(&stream, 0, sizeof(stream));
+	ringBufferInit(&stream.rb, stream.storage, sizeof(stream.storage[0]), capacity);
+
+	if (isrProduces)
+	{
+		pthread_create(&isr, NULL, streamProducer, &stream);
+		streamConsumer(&stream);
+	}
+	else
+	{
+		pthread_create(&isr, NULL, streamConsumer, &stream);
+		streamProducer(&stream);
+	}
+	pthread_join(isr, NULL);
+
+	CHECK(stream.errors == 0);
+	CHECK(ringBufferIsEmpty(&stream.rb));
+}
+
+static void *streamProducer(void *argP)
+{
+	stream_t *streamP = argP;
+
+	for (uint32_t seq = 0; seq < STREAM_ELEMENTS; )
+	{
+		stream_elem_t elem = { seq, ~seq };
+		if (ringBufferPush(&streamP->rb, &elem))
+			seq++;
+		else
+			sched_yield();		// Full: let the other side run even on a single core
+	}
+	return NULL;
+}
+
+static void *streamConsumer(void *argP)
+{
+	stream_t *streamP = argP;
+	stream_elem_t elem;
+
+	for (uint32_t seq = 0; seq < STREAM_ELEMENTS; )
+	{
+		if (!ringBufferPop(&streamP->rb, &elem))
+		{
+			sched_yield();
+			continue;
+		}
+		if (elem.seq != seq || elem.inv != ~seq)
+			streamP->errors++;
+		seq = elem.seq + 1;
+	}
+	return NULL;
+}
+
+/* The ISR rewrites shared32/16 a byte at a time like the AVR would. atomicRead must never see a mix */
+static void testAtomicRead(void)
+{
+	pthread_t isr;
+	unsigned long torn = 0, plainTorn = 0;
+
+	isrRun = true;
+	pthread_create(&isr, NULL, isrWriteBytes, NULL);
+	for (unsigned long i = 0; i < ISR_UPDATES; i++)
+	{
+		/* Plain read first, only to show the test can see tearing at all */
+		const volatile uint8_t *byteP = (const volatile uint8_t *)&shared32;
+		uint32_t plain = byteP[0] | ((uint32_t)byteP[1] << 8) | ((uint32_t)byteP[2] << 16) | ((uint32_t)byteP[3] << 24);
+		if (!bytesEqual32(plain))
+			plainTorn++;
+
+		uint32_t val32 = atomicRead32(&shared32);
+		uint16_t val16 = atomicRead16(&shared16);
+		if (!bytesEqual32(val32) || (val16 >> 8) != (val16 & 0xFF))
+			torn++;
+		hostPreempt();
+	}
+	isrRun = false;
+	pthread_join(isr, NULL);
+
+	CHECK(torn == 0);
+	printf("atomicRead: %lu reads, 0 torn expected, %lu torn (%lu without the helper)\n", ISR_UPDATES, torn, plainTorn);
+}
+
+static void *isrWriteBytes(void *argP)
+{
+	volatile uint8_t *byte32P = (volatile uint8_t *)&shared32;
+	volatile uint8_t *byte16P = (volatile uint8_t *)&shared16;
+	uint8_t val = 0;
+
+	(void)argP;
+	while (isrRun)
+	{
+		ENTER_CRITICAL(I);
+		val++;
+		for (uint8_t i = 0; i < 4; i++)
+		{
+			byte32P[i] = val;
+			hostPreempt();
+		}
+		byte16P[0] = val;
+		hostPreempt();
+		byte16P[1] = val;
+		EXIT_CRITICAL(I);
+		sched_yield();		// Return from interrupt: main always gets to run between two
+	}
+	return NULL;
+}
+
+/* Main writes through atomicWrite, the ISR reads a byte at a time and must never see a mix */
+static void testAtomicWrite(void)
+{
+	pthread_t isr;
+	unsigned long torn = 0;
+
+	shared32 = 0;
+	shared16 = 0;
+	isrRun = true;
+	pthread_create(&isr, NULL, isrCheckBytes, &torn);
+	for (uint32_t i = 0; i < ISR_UPDATES; i++)
+	{
+		uint8_t val = (uint8_t)i;
+		atomicWrite32(&shared32, val * 0x01010101UL);
+		atomicWrite16(&shared16, val * 0x0101U);
+		hostPreempt();
+	}
+	isrRun = false;
+	pthread_join(isr, NULL);
+
+	CHECK(torn == 0);
+}
+
+static void *isrCheckBytes(void *argP)
+{
+	unsigned long *tornP = argP;
+	const volatile uint8_t *byte32P = (const volatile uint8_t *)&shared32;
+	const volatile uint8_t *byte16P = (const volatile uint8_t *)&shared16;
+
+	while (isrRun)
+	{
+		ENTER_CRITICAL(I);
+		if (byte32P[0] != byte32P[1] || byte32P[1] != byte32P[2] || byte32P[2] != byte32P[3] ||
+			byte16P[0] != byte16P[1])
+			(*tornP)++;
+		EXIT_CRITICAL(I);
+		sched_yield();		// Return from interrupt: main always gets to run between two
+	}
+	return NULL;
+}
+
+/* Every event counted and every flag raised by the ISR must be picked up exactly once */
+static void testFetchAndClear(void)
+{
+	pthread_t isr;
+	unsigned long events = 0, flags = 0;
+
+	eventCount = 0;
+	eventFlag = false;
+	isrRun = true;
+	pthread_create(&isr, NULL, isrRaiseEvents, NULL);
+	for (unsigned long i = 0; i < ISR_UPDATES; i++)
+	{
+		events += atomicFetchAndClear8(&eventCount);
+		if (atomicTestAndClear(&eventFlag))
+			flags++;
+		hostPreempt();
+	}
+	isrRun = false;
+	pthread_join(isr, NULL);
+	events += atomicFetchAndClear8(&eventCount);
+	if (atomicTestAndClear(&eventFlag))
+		flags++;
+
+	CHECK(events == eventsRaised);
+	CHECK(flags == flagsRaised);
+	printf("fetchAndClear: %lu events, %lu flags raised\n", eventsRaised, flagsRaised);
+}
+
+/* Read-modify-write in the ISR. The counter is left alone at 255 instead of wrapping, as main would lose 256 */
+static void *isrRaiseEvents(void *argP)
+{
+	(void)argP;
+	while (isrRun)
+	{
+		ENTER_CRITICAL(I);
+		uint8_t count = eventCount;
+		hostPreempt();
+		if (count < UINT8_MAX)
+		{
+			eventCount = count + 1;
+			eventsRaised++;
+		}
+		if (!eventFlag)
+		{
+			eventFlag = true;
+			flagsRaised++;
+		}
+		EXIT_CRITICAL(I);
+		sched_yield();		// Return from interrupt: main always gets to run between two
+	}
+	return NULL;
+}
+
+static bool bytesEqual32(const uint32_t val)
+{
+	return val == (val & 0xFF) * 0x01010101UL;
+}